@@ -0,0 +1,64 @@
+#ifndef GA_ASSEMBLER_HPP
+#define GA_ASSEMBLER_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ga/Graph.hpp"
+
+namespace genome {
+
+// assembly of reads arriving in batches: the graph persists between batches, its weakly
+// connected components are tracked with union-find, and the contigs and the Eulerian path
+// of a component are cached until a new read touches it
+class Assembler {
+public:
+    explicit Assembler(std::size_t k);
+
+    // windows with bases other than ACGT are skipped
+    void addRead(std::string_view read);
+
+    void addReads(const std::vector<std::string>& reads);
+
+    std::size_t k() const { return graph.k(); }
+
+    const DeBruijnGraph& current() const { return graph; }
+
+    std::size_t componentCount() const { return components.size(); }
+
+    // Eulerian path of the component with the most edges, "" if it has no start node
+    std::string assembly();
+
+    // contigs of every component, components in the order their first k-mer was seen
+    std::vector<std::string> contigs();
+
+    // components whose caches were rebuilt so far
+    std::size_t recomputed() const { return rebuilt; }
+
+private:
+    struct Component {
+        std::vector<std::size_t> nodes;
+        std::size_t edges = 0;
+        // smallest node id, i.e. the k-mer seen first
+        std::size_t first = 0;
+        std::optional<std::vector<std::string>> contigs;
+        std::optional<std::string> assembly;
+    };
+
+    DeBruijnGraph graph;
+    std::vector<std::size_t> parent;
+    // keyed by the union-find root
+    std::unordered_map<std::size_t, Component> components;
+    std::size_t rebuilt = 0;
+
+    std::size_t root(std::size_t node);
+    Component& join(std::size_t a, std::size_t b);
+};
+
+}  // namespace genome
+
+#endif  // GA_ASSEMBLER_HPP
@@ -0,0 +1,70 @@
+#ifndef GA_BLOOM_HPP
+#define GA_BLOOM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "ga/Kmer.hpp"
+
+namespace genome {
+
+class BloomFilter {
+public:
+    BloomFilter(std::size_t bits, std::size_t hashes);
+
+    void insert(Kmer kmer);
+
+    bool contains(Kmer kmer) const;
+
+    std::size_t bytes() const { return words.size() * sizeof(std::uint64_t); }
+
+private:
+    std::size_t size;
+    std::size_t hashes;
+    std::vector<std::uint64_t> words;
+};
+
+// probabilistic de Bruijn graph in the style of Chikhi and Rizk: the (k + 1)-mer edges are kept
+// in a Bloom filter only, and the false positives that are one base away from a real node
+// (the critical ones) are kept aside, so walking the graph from real nodes is exact.
+// Edges have no multiplicities, so repeats longer than k cannot be told apart.
+class BloomGraph {
+public:
+    // finding the critical false positives needs the exact edges; they are taken for one of slices
+    // parts of the nodes at a time, so construction holds about 16 / slices bytes per edge on top of
+    // the filter, for the price of two passes over the reads per slice
+    BloomGraph(std::size_t k, const std::vector<std::string>& reads, std::size_t bitsPerEdge = 12,
+               std::size_t slices = 16);
+
+    std::size_t k() const { return kmerSize; }
+
+    // edge leaving kmer by appending base
+    bool hasEdge(Kmer kmer, std::uint8_t base) const { return hasEdge((kmer << 2) | base); }
+
+    std::size_t inDegree(Kmer kmer) const;
+
+    std::size_t outDegree(Kmer kmer) const;
+
+    // nodes other than one edge in and one edge out, in increasing order
+    const std::vector<Kmer>& junctions() const { return branching; }
+
+    std::size_t edgeCount() const { return edges; }
+
+    std::size_t bytes() const;
+
+private:
+    bool hasEdge(Kmer edge) const { return filter.contains(edge) && !criticalFalsePositives.contains(edge); }
+
+    std::size_t kmerSize;
+    std::size_t edges;
+    BloomFilter filter;
+    std::unordered_set<Kmer> criticalFalsePositives;
+    std::vector<Kmer> branching;
+};
+
+}  // namespace genome
+
+#endif  // GA_BLOOM_HPP
@@ -0,0 +1,47 @@
+#ifndef GA_CLEANING_HPP
+#define GA_CLEANING_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ga/Graph.hpp"
+
+namespace genome {
+
+struct CleaningOptions {
+    // edges seen fewer times are treated as sequencing errors
+    std::size_t minAbundance = 2;
+    std::size_t sketchWidth  = std::size_t{1} << 22;
+    std::size_t sketchDepth  = 4;
+    // 0 means 2 * k
+    std::size_t maxTipLength = 0;
+    // 0 means k + 1, the length of a bubble made by one substituted base
+    std::size_t maxBubbleLength = 0;
+    // expected coverage of a single-copy edge, 0 means the median edge count
+    std::size_t coverage = 0;
+};
+
+// two passes over the reads: the first one counts (k + 1)-mers in a count-min sketch,
+// the second one adds to the graph only those seen at least minAbundance times;
+// multiplicities of the result are the counts, not the copy numbers
+DeBruijnGraph buildFiltered(std::size_t k, const std::vector<std::string>& reads, const CleaningOptions& options);
+
+// removes dead-end chains up to maxLength edges that are weaker than the branch they join, and chains
+// up to maxLength edges joining nothing with less than half the median edge count, returns the number of removed edges
+std::size_t removeTips(DeBruijnGraph& graph, std::size_t maxLength);
+
+// removes chains up to maxLength edges that are weaker than the best covered path of up to maxLength edges
+// between the same two nodes, returns the number of removed edges
+std::size_t popBubbles(DeBruijnGraph& graph, std::size_t maxLength);
+
+// turns edge counts into copy numbers, giving every edge of a non-branching chain the mean count of the chain
+// rounded to the nearest multiple of coverage, but never below one
+void normalizeCoverage(DeBruijnGraph& graph, std::size_t coverage = 0);
+
+// assembly of reads with sequencing errors and coverage above one
+std::string assembly(std::size_t k, const std::vector<std::string>& reads, const CleaningOptions& options);
+
+}  // namespace genome
+
+#endif  // GA_CLEANING_HPP
@@ -0,0 +1,22 @@
+#ifndef GA_COMPONENTS_HPP
+#define GA_COMPONENTS_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ga/Graph.hpp"
+
+namespace genome {
+
+// weakly connected components found by a lock-free union-find shared by the threads;
+// the result maps every node to the smallest node id of its component
+std::vector<std::size_t> components(const DeBruijnGraph& graph, std::size_t threads = 1);
+
+// contigs of every component, extracted by the threads one component at a time; components
+// come in the order of their smallest node id, so the result does not depend on threads
+std::vector<std::string> parallelContigs(const DeBruijnGraph& graph, std::size_t threads);
+
+}  // namespace genome
+
+#endif  // GA_COMPONENTS_HPP
@@ -1,13 +1,53 @@
 #ifndef GA_GENOME_HPP
 #define GA_GENOME_HPP
 
+#include <cstddef>
+#include <ostream>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "ga/Graph.hpp"
+#include "ga/Unitig.hpp"
+
 namespace genome {
 
+enum class GraphBackend {
+    // hash map of k-mers with edge multiplicities
+    Exact,
+    // a few bits per edge, but (k + 1)-mers repeated in the genome are not supported
+    Bloom,
+    // reads from both strands, a k-mer and its reverse complement share one entry;
+    // the result is one of the two strands of the genome
+    Canonical,
+    // (k + 1)-mers counted by radix sorting a flat array instead of hash probes
+    Sorted,
+};
+
 std::string assembly(size_t k, const std::vector<std::string>& reads);
 
+std::string assembly(size_t k, const std::vector<std::string>& reads, GraphBackend backend);
+
+// assembly over an already built graph, e.g. one mapped from a graph file and copied by MappedGraph::toGraph
+std::string assembly(const DeBruijnGraph& graph);
+
+std::string assembly(const UnitigGraph& unitigs);
+
+// every maximal non-branching path as its own contig, in one pass over the unitigs and without
+// looking for an Eulerian path, so disconnected or fragmented graphs are fine; a repeated unitig
+// gives one contig, and a double-stranded graph gives one strand of every twin pair
+std::vector<std::string> contigs(const UnitigGraph& unitigs);
+
+// contigs of reads that may contain other letters than ACGT, the (k + 1)-mers spanning them are skipped
+std::vector<std::string> contigs(size_t k, const std::vector<std::string>& reads);
+
+// writes the assembly to out in fixed-size chunks, returns the number of bases written
+std::size_t assembly(const UnitigGraph& unitigs, std::ostream& out);
+
+// writes the assembly to buffer if it fits, otherwise leaves buffer untouched;
+// returns the length of the assembly either way
+std::size_t assembly(const UnitigGraph& unitigs, std::span<char> buffer);
+
 }
 
 #endif  // GA_GENOME_HPP
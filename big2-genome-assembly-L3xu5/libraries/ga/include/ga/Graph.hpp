@@ -0,0 +1,156 @@
+#ifndef GA_GRAPH_HPP
+#define GA_GRAPH_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ga/Kmer.hpp"
+
+namespace genome {
+
+// de Bruijn graph over packed k-mers: every (k + 1)-mer of a read is an edge
+// between its prefix and suffix, repeated (k + 1)-mers give parallel edges
+class DeBruijnGraph {
+public:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    explicit DeBruijnGraph(std::size_t k);
+
+    // the per-k-mer index entries come from arena, typically a monotonic one released in bulk
+    // when the assembly is done; it has to outlive the graph
+    DeBruijnGraph(std::size_t k, std::pmr::memory_resource* arena);
+
+    // windows with bases other than ACGT are skipped, reads not longer than k add nothing
+    void addRead(std::string_view read);
+
+    // adds copies of a packed (k + 1)-mer edge
+    void addEdge(Kmer edge, std::size_t multiplicity = 1);
+
+    // drops every copy of the edge leaving node by appending base
+    void removeEdge(std::size_t node, std::uint8_t base) { setMultiplicity(node, base, 0); }
+
+    // the edge has to be in the graph already, use addEdge for new ones
+    void setMultiplicity(std::size_t node, std::uint8_t base, std::size_t multiplicity);
+
+    // adds the nodes and edges of a graph with the same k, shared nodes are glued
+    void merge(const DeBruijnGraph& other);
+
+    std::size_t k() const { return kmerSize; }
+
+    std::size_t nodeCount() const { return nodes.size(); }
+
+    std::size_t edgeCount() const { return edges; }
+
+    Kmer kmer(std::size_t node) const { return nodes[node].kmer; }
+
+    std::size_t find(Kmer kmer) const;
+
+    // number of parallel edges leaving node by appending base
+    std::size_t multiplicity(std::size_t node, std::uint8_t base) const { return nodes[node].out[base]; }
+
+    std::size_t successor(std::size_t node, std::uint8_t base) const {
+        return find(appendBase(nodes[node].kmer, base, kmerSize));
+    }
+
+    // node whose k-mer is base followed by the first k - 1 bases of node
+    std::size_t predecessor(std::size_t node, std::uint8_t base) const {
+        return find((static_cast<Kmer>(base) << (2 * (kmerSize - 1))) | (nodes[node].kmer >> 2));
+    }
+
+    std::size_t inDegree(std::size_t node) const { return nodes[node].in; }
+
+    std::size_t outDegree(std::size_t node) const;
+
+private:
+    struct Node {
+        Kmer kmer;
+        std::array<std::size_t, 4> out{};
+        std::size_t in = 0;
+    };
+
+    std::size_t kmerSize;
+    std::size_t edges = 0;
+    std::vector<Node> nodes;
+    std::pmr::unordered_map<Kmer, std::size_t> index;
+
+    std::size_t addNode(Kmer kmer);
+};
+
+// copy of the edges leaving the given nodes, e.g. the ones of a connected component,
+// for the whole-graph algorithms; the index of the copy comes from arena as in DeBruijnGraph(k, arena)
+DeBruijnGraph subgraph(const DeBruijnGraph& graph, const std::vector<std::size_t>& nodes,
+                       std::pmr::memory_resource* arena = std::pmr::get_default_resource());
+
+// bidirected de Bruijn graph for reads from both strands: a k-mer and its reverse complement
+// share one entry keyed by the canonical k-mer. Nodes are oriented, 2 * entry + 1 being
+// the entry read as the reverse complement, and every edge is kept in both orientations.
+// An entry holds the counts of the edges leaving both orientations, the edges entering one
+// orientation are the twins of those leaving the other, so a k-mer and its reverse complement
+// take 40 bytes together against 96 for their two DeBruijnGraph nodes
+class CanonicalGraph {
+public:
+    static constexpr std::size_t npos = DeBruijnGraph::npos;
+
+    explicit CanonicalGraph(std::size_t k);
+
+    // see DeBruijnGraph(k, arena)
+    CanonicalGraph(std::size_t k, std::pmr::memory_resource* arena);
+
+    // windows with bases other than ACGT are skipped
+    void addRead(std::string_view read);
+
+    void addEdge(Kmer edge);
+
+    std::size_t k() const { return kmerSize; }
+
+    std::size_t nodeCount() const { return 2 * entries.size(); }
+
+    // number of stored canonical k-mers
+    std::size_t kmerCount() const { return entries.size(); }
+
+    std::size_t edgeCount() const { return edges; }
+
+    Kmer kmer(std::size_t node) const {
+        return node % 2 ? reverseComplement(entries[node / 2].kmer, kmerSize) : entries[node / 2].kmer;
+    }
+
+    // oriented node spelling kmer
+    std::size_t find(Kmer kmer) const;
+
+    std::size_t multiplicity(std::size_t node, std::uint8_t base) const {
+        return entries[node / 2].out[node % 2][base];
+    }
+
+    std::size_t successor(std::size_t node, std::uint8_t base) const {
+        return find(appendBase(kmer(node), base, kmerSize));
+    }
+
+    std::size_t inDegree(std::size_t node) const;
+
+    std::size_t outDegree(std::size_t node) const;
+
+private:
+    // a single edge repeated more than 2^32 times is not expected from reads
+    struct Entry {
+        Kmer kmer;
+        std::array<std::array<std::uint32_t, 4>, 2> out{};
+    };
+
+    std::size_t kmerSize;
+    std::size_t edges = 0;
+    std::vector<Entry> entries;
+    std::pmr::unordered_map<Kmer, std::size_t> index;
+
+    std::size_t addNode(Kmer kmer);
+    void addArc(std::size_t from, std::uint8_t base);
+};
+
+}  // namespace genome
+
+#endif  // GA_GRAPH_HPP
@@ -0,0 +1,94 @@
+#ifndef GA_GRAPH_FILE_HPP
+#define GA_GRAPH_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#include "ga/Graph.hpp"
+#include "ga/Kmer.hpp"
+
+namespace genome {
+
+// binary graph file, all fields in host byte order:
+//   header (magic, version, k, byte order mark, node, arc and edge counts)
+//   kmers[nodes], in[nodes], offsets[nodes + 1], targets[arcs], multiplicities[arcs], order[nodes]
+// every array entry is a uint64_t; the arcs leaving node are offsets[node] .. offsets[node + 1] - 1,
+// order holds the nodes sorted by k-mer for lookups
+constexpr std::uint32_t graphFileVersion = 1;
+
+void saveGraph(const DeBruijnGraph& graph, const std::filesystem::path& path);
+
+// files holding the raw values of the arrays of a graph file, for graphs built out of memory
+struct GraphArrayFiles {
+    std::filesystem::path kmers;
+    std::filesystem::path in;
+    std::filesystem::path offsets;
+    std::filesystem::path targets;
+    std::filesystem::path multiplicities;
+};
+
+// graph file from arrays already on disk, copied through a small buffer; the nodes have to be
+// sorted by k-mer, order is then the identity
+void saveGraph(std::size_t k, std::size_t nodes, std::size_t arcs, std::size_t edges, const GraphArrayFiles& arrays,
+               const std::filesystem::path& path);
+
+// read-only graph straight from a mapped graph file, nothing is parsed or copied;
+// it has the query interface of DeBruijnGraph, so UnitigGraph can be built from it
+class MappedGraph {
+public:
+    static constexpr std::size_t npos = DeBruijnGraph::npos;
+
+    // throws std::runtime_error if the file cannot be mapped, is not a graph file of this version or is
+    // damaged: k too large, arc offsets not monotone or not spanning the arcs, nodes out of range
+    explicit MappedGraph(const std::filesystem::path& path);
+
+    MappedGraph(MappedGraph&& other) noexcept;
+
+    MappedGraph(const MappedGraph&)            = delete;
+    MappedGraph& operator=(const MappedGraph&) = delete;
+    MappedGraph& operator=(MappedGraph&&)      = delete;
+
+    ~MappedGraph();
+
+    std::size_t k() const { return kmerSize; }
+
+    std::size_t nodeCount() const { return nodes; }
+
+    std::size_t edgeCount() const { return edges; }
+
+    Kmer kmer(std::size_t node) const { return kmers[node]; }
+
+    std::size_t find(Kmer kmer) const;
+
+    std::size_t multiplicity(std::size_t node, std::uint8_t base) const;
+
+    std::size_t successor(std::size_t node, std::uint8_t base) const;
+
+    std::size_t inDegree(std::size_t node) const { return in[node]; }
+
+    std::size_t outDegree(std::size_t node) const;
+
+    // mutable copy, e.g. to clean it with other parameters
+    DeBruijnGraph toGraph() const;
+
+private:
+    void* mapping     = nullptr;
+    std::size_t bytes = 0;
+    std::size_t kmerSize;
+    std::size_t nodes;
+    std::size_t edges;
+    const std::uint64_t* kmers;
+    const std::uint64_t* in;
+    const std::uint64_t* offsets;
+    const std::uint64_t* targets;
+    const std::uint64_t* multiplicities;
+    const std::uint64_t* order;
+
+    // arc leaving node by appending base, offsets[node + 1] if there is none
+    std::size_t arc(std::size_t node, std::uint8_t base) const;
+};
+
+}  // namespace genome
+
+#endif  // GA_GRAPH_FILE_HPP
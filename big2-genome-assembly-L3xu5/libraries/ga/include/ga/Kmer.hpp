@@ -0,0 +1,206 @@
+#ifndef GA_KMER_HPP
+#define GA_KMER_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace genome {
+
+// k-mer packed 2 bits per base, the last base in the lowest bits
+using Kmer = std::uint64_t;
+
+// edges of the graph are (k + 1)-mers, so they have to fit into one Kmer as well
+constexpr std::size_t maxPackedK = 31;
+
+constexpr std::uint8_t invalidBase = 4;
+
+constexpr std::uint8_t encodeBase(const char base) {
+    switch (base) {
+        case 'A':
+            return 0;
+        case 'C':
+            return 1;
+        case 'G':
+            return 2;
+        case 'T':
+            return 3;
+        default:
+            return invalidBase;
+    }
+}
+
+constexpr char decodeBase(const std::uint8_t code) { return "ACGT"[code & 3]; }
+
+constexpr Kmer kmerMask(const std::size_t k) { return k >= 32 ? ~Kmer{0} : (Kmer{1} << (2 * k)) - 1; }
+
+constexpr Kmer appendBase(const Kmer kmer, const std::uint8_t code, const std::size_t k) {
+    return ((kmer << 2) | code) & kmerMask(k);
+}
+
+constexpr std::uint8_t lastBase(const Kmer kmer) { return kmer & 3; }
+
+constexpr std::uint8_t firstBase(const Kmer kmer, const std::size_t k) { return (kmer >> (2 * (k - 1))) & 3; }
+
+// with A, C, G, T as 0, 1, 2, 3 the complement of a base is its bitwise negation
+constexpr std::uint8_t complementBase(const std::uint8_t code) { return 3 - code; }
+
+// complements all bases at once and reverses the order of the 2-bit groups
+// by swapping ever larger halves of the word, k has to be positive
+constexpr Kmer reverseComplement(Kmer kmer, const std::size_t k) {
+    kmer = ~kmer;
+    kmer = ((kmer >> 2) & 0x3333333333333333ULL) | ((kmer & 0x3333333333333333ULL) << 2);
+    kmer = ((kmer >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((kmer & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    kmer = ((kmer >> 8) & 0x00FF00FF00FF00FFULL) | ((kmer & 0x00FF00FF00FF00FFULL) << 8);
+    kmer = ((kmer >> 16) & 0x0000FFFF0000FFFFULL) | ((kmer & 0x0000FFFF0000FFFFULL) << 16);
+    kmer = (kmer >> 32) | (kmer << 32);
+    return kmer >> (64 - 2 * k);
+}
+
+// the smaller of a k-mer and its reverse complement, which stands for both strands
+struct CanonicalKmer {
+    Kmer kmer;
+    bool reversed;
+};
+
+constexpr CanonicalKmer canonical(const Kmer kmer, const std::size_t k) {
+    Kmer reversed = reverseComplement(kmer, k);
+    return reversed < kmer ? CanonicalKmer{reversed, true} : CanonicalKmer{kmer, false};
+}
+
+// splitmix64 finalizer, spreads packed k-mers evenly over tables, sketches and buckets
+constexpr std::uint64_t hashKmer(Kmer kmer, const std::uint64_t seed = 0) {
+    kmer += seed * 0x9e3779b97f4a7c15ULL;
+    kmer ^= kmer >> 30;
+    kmer *= 0xbf58476d1ce4e5b9ULL;
+    kmer ^= kmer >> 27;
+    kmer *= 0x94d049bb133111ebULL;
+    kmer ^= kmer >> 31;
+    return kmer;
+}
+
+// bases encoded by one encodeBlock call at most
+constexpr std::size_t blockBases = 64;
+
+// encodes count <= blockBases letters at once into 2-bit codes, one per byte, with SIMD where
+// the target has it; bit i of the result is set when ascii[i] is not one of ACGT, and codes[i]
+// is meaningless then
+std::uint64_t encodeBlock(const char* ascii, std::size_t count, std::uint8_t* codes);
+
+// calls f(kmer) for every n-mer of the read, skipping the ones with bases other than ACGT
+template <class F>
+void forEachKmer(std::string_view read, const std::size_t n, F&& f) {
+    Kmer kmer         = 0;
+    std::size_t valid = 0;
+    std::array<std::uint8_t, blockBases> codes;
+    for (std::size_t start = 0; start < read.size(); start += blockBases) {
+        const std::size_t count = std::min(blockBases, read.size() - start);
+        std::uint64_t invalid   = encodeBlock(read.data() + start, count, codes.data());
+        for (std::size_t i = 0; i < count; i++) {
+            if ((invalid >> i) & 1) {
+                valid = 0;
+                continue;
+            }
+            kmer = appendBase(kmer, codes[i], n);
+            if (++valid >= n)
+                f(kmer);
+        }
+    }
+}
+
+// calls f(run) for every maximal run of ACGT in read, i.e. splits it at ambiguous bases
+template <class F>
+void forEachRun(std::string_view read, F&& f) {
+    std::array<std::uint8_t, blockBases> codes;
+    std::size_t runStart = 0;
+    for (std::size_t start = 0; start < read.size(); start += blockBases) {
+        const std::size_t count = std::min(blockBases, read.size() - start);
+        std::uint64_t invalid   = encodeBlock(read.data() + start, count, codes.data());
+        for (; invalid != 0; invalid &= invalid - 1) {
+            std::size_t end = start + static_cast<std::size_t>(std::countr_zero(invalid));
+            if (end > runStart)
+                f(read.substr(runStart, end - runStart));
+            runStart = end + 1;
+        }
+    }
+    if (read.size() > runStart)
+        f(read.substr(runStart));
+}
+
+bool isPackable(std::string_view read);
+
+Kmer packKmer(std::string_view bases);
+
+std::string unpackKmer(Kmer kmer, std::size_t k);
+
+// writes the k bases to out instead of a new string
+void unpackKmer(Kmer kmer, std::size_t k, char* out);
+
+class PackedSequence {
+public:
+    std::size_t size() const { return length; }
+
+    bool empty() const { return length == 0; }
+
+    void reserve(std::size_t bases) { words.reserve((bases + basesPerWord - 1) / basesPerWord); }
+
+    void push_back(std::uint8_t code);
+
+    std::uint8_t operator[](std::size_t i) const {
+        return (words[i / basesPerWord] >> (2 * (i % basesPerWord))) & 3;
+    }
+
+    // writes bases first .. first + count - 1 to out as letters, a word at a time
+    void decode(std::size_t first, std::size_t count, char* out) const;
+
+    // memory taken by the packed bases, in bytes
+    std::size_t bytes() const { return words.size() * sizeof(std::uint64_t); }
+
+private:
+    static constexpr std::size_t basesPerWord = 32;
+
+    std::vector<std::uint64_t> words;
+    std::size_t length = 0;
+};
+
+// reads packed once, 2 bits per base, and cut into runs of ACGT at every other letter,
+// so k-mers of any size can be taken again without encoding the strings anew
+class PackedReads {
+public:
+    void add(std::string_view read);
+
+    // number of ACGT runs
+    std::size_t size() const { return ends.size(); }
+
+    std::size_t bases() const { return sequence.size(); }
+
+    std::size_t bytes() const { return sequence.bytes() + ends.size() * sizeof(std::size_t); }
+
+    // calls f(kmer) for every n-mer of every run
+    template <class F>
+    void forEachKmer(const std::size_t n, F&& f) const {
+        std::size_t start = 0;
+        for (std::size_t end : ends) {
+            Kmer kmer = 0;
+            for (std::size_t i = start; i < end; i++) {
+                kmer = appendBase(kmer, sequence[i], n);
+                if (i + 1 - start >= n)
+                    f(kmer);
+            }
+            start = end;
+        }
+    }
+
+private:
+    PackedSequence sequence;
+    std::vector<std::size_t> ends;
+};
+
+}  // namespace genome
+
+#endif  // GA_KMER_HPP
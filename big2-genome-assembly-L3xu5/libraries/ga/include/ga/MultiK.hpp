@@ -0,0 +1,18 @@
+#ifndef GA_MULTIK_HPP
+#define GA_MULTIK_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace genome {
+
+// multi-k assembly in the style of IDBA: the reads are packed once, and every round builds
+// the graph of the distinct (k + 1)-mers of the reads plus the contigs of the previous round,
+// so coverage gaps that break the graph at a large k are bridged by contigs from a smaller one;
+// ks have to be increasing and at most maxPackedK, the contigs of the last round are returned
+std::vector<std::string> multiKContigs(const std::vector<std::string>& reads, const std::vector<std::size_t>& ks);
+
+}  // namespace genome
+
+#endif  // GA_MULTIK_HPP
@@ -0,0 +1,44 @@
+#ifndef GA_PARALLEL_HPP
+#define GA_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace genome {
+
+// runs f(i) for i in 0 .. count - 1 on the given number of threads, the calling one included;
+// the first exception stops the remaining work and is rethrown
+template <class F>
+void parallelFor(const std::size_t count, const std::size_t threads, F&& f) {
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    auto worker = [&] {
+        for (std::size_t i; !failed && (i = next.fetch_add(1)) < count;) {
+            try {
+                f(i);
+            } catch (...) {
+                if (!failed.exchange(true))
+                    error = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (std::size_t i = 1; i < std::min(threads, count); i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+}  // namespace genome
+
+#endif  // GA_PARALLEL_HPP
@@ -0,0 +1,34 @@
+#ifndef GA_PARTITION_HPP
+#define GA_PARTITION_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <istream>
+
+#include "ga/GraphFile.hpp"
+
+namespace genome {
+
+struct DiskOptions {
+    // every call makes its own uniquely named scratch directory in here and removes it when done
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    // bytes the bucket graphs being built at the same time may take together;
+    // buckets estimated above it are split further before being built
+    std::size_t memoryBudget  = std::size_t{1} << 30;
+    std::size_t buckets       = 64;
+    std::size_t minimizerSize = 10;
+    std::size_t threads       = 1;
+};
+
+// builds the graph of the reads (one per line, split at bases other than ACGT) without holding
+// the reads or the graph in memory: reads are cut into super-k-mers sharing a minimizer and
+// spread by minimizer over bucket files, every bucket graph is built on its own and written out
+// as sorted runs of k-mers and edges, and the runs are merged into graphFile, which is returned mapped.
+// Memory stays within the budget plus a buffer per run, whatever the size of the genome,
+// unless a single minimizer has more edges than the budget allows; such a bucket is built alone
+MappedGraph buildOnDisk(std::size_t k, std::istream& reads, const std::filesystem::path& graphFile,
+                        const DiskOptions& options = {});
+
+}  // namespace genome
+
+#endif  // GA_PARTITION_HPP
@@ -0,0 +1,33 @@
+#ifndef GA_SKETCH_HPP
+#define GA_SKETCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ga/Kmer.hpp"
+
+namespace genome {
+
+// count-min sketch of k-mer abundances: counts are never underestimated,
+// collisions can only raise them; counters saturate instead of wrapping
+class CountMinSketch {
+public:
+    // width is rounded up to a power of two
+    CountMinSketch(std::size_t width, std::size_t depth);
+
+    void add(Kmer kmer);
+
+    std::size_t count(Kmer kmer) const;
+
+    std::size_t bytes() const { return counters.size() * sizeof(std::uint16_t); }
+
+private:
+    std::size_t rows;
+    std::size_t mask;
+    std::vector<std::uint16_t> counters;
+};
+
+}  // namespace genome
+
+#endif  // GA_SKETCH_HPP
@@ -0,0 +1,65 @@
+#ifndef GA_SORTED_HPP
+#define GA_SORTED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ga/Graph.hpp"
+#include "ga/Kmer.hpp"
+
+namespace genome {
+
+// LSD radix sort of the lowest bits of values, one byte (four bases) per pass; every pass
+// counts and scatters contiguous blocks of the input on their own threads, which keeps it
+// stable, and passes where all values share the digit are skipped
+void radixSort(std::vector<Kmer>& values, std::size_t bits, std::size_t threads = 1);
+
+// de Bruijn graph counted by sorting instead of hashing: the (k + 1)-mers of the reads are
+// radix sorted and counted by runs, so the arcs leaving a node are a contiguous run of the
+// sorted edges and make the CSR arrays directly; nodes are numbered in k-mer order.
+// Takes 8 bytes per (k + 1)-mer occurrence while building
+class SortedGraph {
+public:
+    static constexpr std::size_t npos = DeBruijnGraph::npos;
+
+    // windows with bases other than ACGT are skipped
+    SortedGraph(std::size_t k, const std::vector<std::string>& reads, std::size_t threads = 1);
+
+    std::size_t k() const { return kmerSize; }
+
+    std::size_t nodeCount() const { return kmers.size(); }
+
+    std::size_t edgeCount() const { return edges; }
+
+    Kmer kmer(std::size_t node) const { return kmers[node]; }
+
+    std::size_t find(Kmer kmer) const;
+
+    std::size_t multiplicity(std::size_t node, std::uint8_t base) const;
+
+    std::size_t successor(std::size_t node, std::uint8_t base) const;
+
+    std::size_t inDegree(std::size_t node) const { return in[node]; }
+
+    std::size_t outDegree(std::size_t node) const;
+
+private:
+    std::size_t kmerSize;
+    std::size_t edges = 0;
+    std::vector<Kmer> kmers;
+    std::vector<std::size_t> in;
+    // the arcs leaving node are offsets[node] .. offsets[node + 1] - 1
+    std::vector<std::size_t> offsets;
+    std::vector<std::uint8_t> bases;
+    std::vector<std::size_t> targets;
+    std::vector<std::size_t> multiplicities;
+
+    // arc leaving node by appending base, offsets[node + 1] if there is none
+    std::size_t arc(std::size_t node, std::uint8_t base) const;
+};
+
+}  // namespace genome
+
+#endif  // GA_SORTED_HPP
@@ -0,0 +1,83 @@
+#ifndef GA_UNITIG_HPP
+#define GA_UNITIG_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "ga/Bloom.hpp"
+#include "ga/Graph.hpp"
+#include "ga/GraphFile.hpp"
+#include "ga/Kmer.hpp"
+#include "ga/Sorted.hpp"
+
+namespace genome {
+
+// maximal non-branching chain of edges, spelled by the bases it appends to the k-mer of `from`
+struct Unitig {
+    std::size_t from;
+    std::size_t to;
+    std::size_t offset;
+    std::size_t length;
+    std::size_t multiplicity;
+};
+
+// de Bruijn graph with every non-branching chain collapsed into a single edge;
+// nodes are the branching k-mers only (plus one anchor per isolated cycle)
+class UnitigGraph {
+public:
+    explicit UnitigGraph(const DeBruijnGraph& graph);
+
+    explicit UnitigGraph(const MappedGraph& graph);
+
+    explicit UnitigGraph(const SortedGraph& graph);
+
+    // isolated cycles are not found here, the Bloom graph cannot enumerate their nodes
+    explicit UnitigGraph(const BloomGraph& graph);
+
+    // every unitig comes with its reverse complement twin, see twin()
+    explicit UnitigGraph(const CanonicalGraph& graph);
+
+    std::size_t k() const { return kmerSize; }
+
+    std::size_t nodeCount() const { return kmers.size(); }
+
+    Kmer kmer(std::size_t node) const { return kmers[node]; }
+
+    const std::vector<Unitig>& unitigs() const { return edges; }
+
+    // unitigs leaving node are edges[firstOut[node]] .. edges[firstOut[node + 1] - 1]
+    std::size_t firstOut(std::size_t node) const { return outOffsets[node]; }
+
+    std::size_t inDegree(std::size_t node) const { return in[node]; }
+
+    std::size_t outDegree(std::size_t node) const { return out[node]; }
+
+    const PackedSequence& bases() const { return sequence; }
+
+    bool doubleStranded() const { return !twins.empty(); }
+
+    // unitig spelling the reverse complement of the given one, only for double-stranded graphs
+    std::size_t twin(std::size_t unitig) const { return twins[unitig]; }
+
+private:
+    std::size_t kmerSize;
+    std::vector<Kmer> kmers;
+    std::vector<std::size_t> in;
+    std::vector<std::size_t> out;
+    std::vector<std::size_t> outOffsets;
+    std::vector<Unitig> edges;
+    std::vector<std::size_t> twins;
+    PackedSequence sequence;
+
+    // returns the junction of every graph node, npos for the collapsed ones
+    template <class Graph>
+    std::vector<std::size_t> compact(const Graph& graph);
+};
+
+// Eulerian path over the unitigs starting at node, as a sequence of unitig indices;
+// on a double-stranded graph a unitig and its twin are used up together
+std::vector<std::size_t> findWay(const UnitigGraph& graph, std::size_t start);
+
+}  // namespace genome
+
+#endif  // GA_UNITIG_HPP
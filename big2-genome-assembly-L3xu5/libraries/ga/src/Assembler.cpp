@@ -0,0 +1,100 @@
+#include "ga/Assembler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "ga/Genome.hpp"
+#include "ga/Unitig.hpp"
+
+namespace genome {
+
+Assembler::Assembler(const std::size_t k) : graph(k) {
+    if (k == 0 || k > maxPackedK)
+        throw std::invalid_argument("incremental assembly needs 0 < k <= " + std::to_string(maxPackedK));
+}
+
+std::size_t Assembler::root(std::size_t node) {
+    while (parent[node] != node) {
+        parent[node] = parent[parent[node]];
+        node         = parent[node];
+    }
+    return node;
+}
+
+Assembler::Component& Assembler::join(std::size_t a, std::size_t b) {
+    a = root(a);
+    b = root(b);
+    if (a != b) {
+        // the smaller member list moves, so every node moves O(log n) times
+        if (components[a].nodes.size() < components[b].nodes.size())
+            std::swap(a, b);
+        Component& big   = components[a];
+        Component& small = components[b];
+        big.nodes.insert(big.nodes.end(), small.nodes.begin(), small.nodes.end());
+        big.edges += small.edges;
+        big.first = std::min(big.first, small.first);
+        components.erase(b);
+        parent[b] = a;
+    }
+    Component& joined = components[a];
+    joined.contigs.reset();
+    joined.assembly.reset();
+    return joined;
+}
+
+void Assembler::addRead(const std::string_view read) {
+    forEachKmer(read, k() + 1, [&](Kmer edge) {
+        graph.addEdge(edge);
+        // new nodes get the next ids and start as components of their own
+        while (parent.size() < graph.nodeCount()) {
+            std::size_t node = parent.size();
+            parent.push_back(node);
+            Component& component = components[node];
+            component.nodes.push_back(node);
+            component.first = node;
+        }
+        join(graph.find(edge >> 2), graph.find(edge & kmerMask(k()))).edges++;
+    });
+}
+
+void Assembler::addReads(const std::vector<std::string>& reads) {
+    for (const auto& read : reads) {
+        addRead(read);
+    }
+}
+
+std::string Assembler::assembly() {
+    Component* largest = nullptr;
+    for (auto& [_, component] : components) {
+        if (largest == nullptr || component.edges > largest->edges ||
+            (component.edges == largest->edges && component.first < largest->first))
+            largest = &component;
+    }
+    if (largest == nullptr)
+        return "";
+    if (!largest->assembly) {
+        largest->assembly = genome::assembly(subgraph(graph, largest->nodes));
+        rebuilt++;
+    }
+    return *largest->assembly;
+}
+
+std::vector<std::string> Assembler::contigs() {
+    std::vector<Component*> order;
+    order.reserve(components.size());
+    for (auto& [_, component] : components) {
+        order.push_back(&component);
+    }
+    std::sort(order.begin(), order.end(), [](auto a, auto b) { return a->first < b->first; });
+    std::vector<std::string> result;
+    for (Component* component : order) {
+        if (!component->contigs) {
+            component->contigs = genome::contigs(UnitigGraph(subgraph(graph, component->nodes)));
+            rebuilt++;
+        }
+        result.insert(result.end(), component->contigs->begin(), component->contigs->end());
+    }
+    return result;
+}
+
+}  // namespace genome
@@ -0,0 +1,142 @@
+#include "ga/Bloom.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace genome {
+
+namespace {
+
+std::size_t slice(const Kmer node, const std::size_t slices) { return hashKmer(node, 3) % slices; }
+
+// real edges leaving or entering a node of the slice, sorted and without duplicates
+std::vector<Kmer> sliceEdges(const std::size_t k, const std::vector<std::string>& reads, const std::size_t index,
+                             const std::size_t slices) {
+    std::vector<Kmer> edges;
+    for (const auto& read : reads) {
+        forEachKmer(read, k + 1, [&](Kmer edge) {
+            if (slice(edge >> 2, slices) == index || slice(edge & kmerMask(k), slices) == index)
+                edges.push_back(edge);
+        });
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    return edges;
+}
+
+std::size_t countEdges(const std::size_t k, const std::vector<std::string>& reads, const std::size_t slices) {
+    if (k == 0 || k > maxPackedK)
+        throw std::invalid_argument("Bloom graph needs 0 < k <= " + std::to_string(maxPackedK));
+    if (slices == 0)
+        throw std::invalid_argument("Bloom graph needs at least one slice");
+    std::size_t count = 0;
+    std::vector<Kmer> edges;
+    for (std::size_t index = 0; index < slices; index++) {
+        // every edge is counted in the slice of the node it leaves
+        edges.clear();
+        for (const auto& read : reads) {
+            forEachKmer(read, k + 1, [&](Kmer edge) {
+                if (slice(edge >> 2, slices) == index)
+                    edges.push_back(edge);
+            });
+        }
+        std::sort(edges.begin(), edges.end());
+        count += static_cast<std::size_t>(std::unique(edges.begin(), edges.end()) - edges.begin());
+    }
+    return count;
+}
+
+}  // namespace
+
+BloomFilter::BloomFilter(const std::size_t bits, const std::size_t hashes)
+    : size(std::max<std::size_t>(bits, 64)), hashes(std::max<std::size_t>(hashes, 1)), words((size + 63) / 64, 0) {}
+
+void BloomFilter::insert(const Kmer kmer) {
+    // double hashing, the second hash is odd so that all probes differ
+    std::uint64_t h1 = hashKmer(kmer, 1);
+    std::uint64_t h2 = hashKmer(kmer, 2) | 1;
+    for (std::size_t i = 0; i < hashes; i++) {
+        std::size_t bit = (h1 + i * h2) % size;
+        words[bit / 64] |= std::uint64_t{1} << (bit % 64);
+    }
+}
+
+bool BloomFilter::contains(const Kmer kmer) const {
+    std::uint64_t h1 = hashKmer(kmer, 1);
+    std::uint64_t h2 = hashKmer(kmer, 2) | 1;
+    for (std::size_t i = 0; i < hashes; i++) {
+        std::size_t bit = (h1 + i * h2) % size;
+        if ((words[bit / 64] & (std::uint64_t{1} << (bit % 64))) == 0)
+            return false;
+    }
+    return true;
+}
+
+BloomGraph::BloomGraph(const std::size_t k, const std::vector<std::string>& reads, const std::size_t bitsPerEdge,
+                       const std::size_t slices)
+    : kmerSize(k),
+      edges(countEdges(k, reads, slices)),
+      filter(edges * bitsPerEdge,
+             static_cast<std::size_t>(std::lround(static_cast<double>(bitsPerEdge) * std::log(2.0)))) {
+    for (const auto& read : reads) {
+        forEachKmer(read, k + 1, [&](Kmer edge) { filter.insert(edge); });
+    }
+    // every extension of a real node answered positively by the filter must be real; the nodes are checked
+    // a slice at a time, each against the exact edges touching its slice, 8 bytes per such edge
+    for (std::size_t index = 0; index < slices; index++) {
+        const std::vector<Kmer> realEdges = sliceEdges(k, reads, index, slices);
+        auto isReal = [&](Kmer edge) { return std::binary_search(realEdges.begin(), realEdges.end(), edge); };
+        auto checkNode = [&](Kmer kmer) {
+            if (slice(kmer, slices) != index)
+                return;
+            for (std::uint8_t base = 0; base < 4; base++) {
+                Kmer out = (kmer << 2) | base;
+                Kmer in  = (static_cast<Kmer>(base) << (2 * k)) | kmer;
+                if (filter.contains(out) && !isReal(out))
+                    criticalFalsePositives.insert(out);
+                if (filter.contains(in) && !isReal(in))
+                    criticalFalsePositives.insert(in);
+            }
+        };
+        for (Kmer edge : realEdges) {
+            checkNode(edge >> 2);
+            checkNode(edge & kmerMask(k));
+        }
+    }
+    for (const auto& read : reads) {
+        forEachKmer(read, k, [&](Kmer kmer) {
+            std::size_t in  = inDegree(kmer);
+            std::size_t out = outDegree(kmer);
+            if (in + out > 0 && (in != 1 || out != 1))
+                branching.push_back(kmer);
+        });
+    }
+    std::sort(branching.begin(), branching.end());
+    branching.erase(std::unique(branching.begin(), branching.end()), branching.end());
+}
+
+std::size_t BloomGraph::inDegree(const Kmer kmer) const {
+    std::size_t degree = 0;
+    for (std::uint8_t base = 0; base < 4; base++) {
+        if (hasEdge((static_cast<Kmer>(base) << (2 * kmerSize)) | kmer))
+            degree++;
+    }
+    return degree;
+}
+
+std::size_t BloomGraph::outDegree(const Kmer kmer) const {
+    std::size_t degree = 0;
+    for (std::uint8_t base = 0; base < 4; base++) {
+        if (hasEdge(kmer, base))
+            degree++;
+    }
+    return degree;
+}
+
+std::size_t BloomGraph::bytes() const {
+    // a node of the false positive set costs about the key, the next pointer and a bucket
+    return filter.bytes() + criticalFalsePositives.size() * 3 * sizeof(Kmer) + branching.size() * sizeof(Kmer);
+}
+
+}  // namespace genome
@@ -0,0 +1,283 @@
+#include "ga/Cleaning.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "ga/Genome.hpp"
+#include "ga/Kmer.hpp"
+#include "ga/Sketch.hpp"
+
+namespace genome {
+
+namespace {
+
+struct Edge {
+    std::size_t from;
+    std::uint8_t base;
+};
+
+// non-branching run of edges, coverage is the sum of their multiplicities
+struct Branch {
+    std::vector<Edge> edges;
+    std::size_t end      = DeBruijnGraph::npos;
+    std::size_t coverage = 0;
+};
+
+std::size_t successors(const DeBruijnGraph& graph, const std::size_t node) {
+    std::size_t count = 0;
+    for (std::uint8_t base = 0; base < 4; base++) {
+        if (graph.multiplicity(node, base) > 0)
+            count++;
+    }
+    return count;
+}
+
+// multiplicity of the edge entering node from the predecessor starting with base
+std::size_t inMultiplicity(const DeBruijnGraph& graph, const std::size_t node, const std::uint8_t base) {
+    std::size_t pred = graph.predecessor(node, base);
+    return pred == DeBruijnGraph::npos ? 0 : graph.multiplicity(pred, lastBase(graph.kmer(node)));
+}
+
+std::size_t predecessors(const DeBruijnGraph& graph, const std::size_t node) {
+    std::size_t count = 0;
+    for (std::uint8_t base = 0; base < 4; base++) {
+        if (inMultiplicity(graph, node, base) > 0)
+            count++;
+    }
+    return count;
+}
+
+bool isChain(const DeBruijnGraph& graph, const std::size_t node) {
+    return predecessors(graph, node) == 1 && successors(graph, node) == 1;
+}
+
+std::uint8_t successorBase(const DeBruijnGraph& graph, const std::size_t node) {
+    std::uint8_t base = 0;
+    while (graph.multiplicity(node, base) == 0) {
+        base++;
+    }
+    return base;
+}
+
+std::uint8_t predecessorBase(const DeBruijnGraph& graph, const std::size_t node) {
+    std::uint8_t base = 0;
+    while (inMultiplicity(graph, node, base) == 0) {
+        base++;
+    }
+    return base;
+}
+
+// follows the edge and then chain nodes, stops after maxLength + 1 edges at most
+Branch walkForward(const DeBruijnGraph& graph, std::size_t node, std::uint8_t base, const std::size_t maxLength) {
+    Branch branch;
+    while (true) {
+        branch.edges.push_back({node, base});
+        branch.coverage += graph.multiplicity(node, base);
+        node = graph.successor(node, base);
+        if (branch.edges.size() > maxLength || !isChain(graph, node))
+            break;
+        base = successorBase(graph, node);
+    }
+    branch.end = node;
+    return branch;
+}
+
+Branch walkBackward(const DeBruijnGraph& graph, std::size_t node, const std::size_t maxLength) {
+    Branch branch;
+    while (true) {
+        std::size_t pred  = graph.predecessor(node, predecessorBase(graph, node));
+        std::uint8_t base = lastBase(graph.kmer(node));
+        branch.edges.push_back({pred, base});
+        branch.coverage += graph.multiplicity(pred, base);
+        node = pred;
+        if (branch.edges.size() > maxLength || !isChain(graph, node))
+            break;
+    }
+    branch.end = node;
+    return branch;
+}
+
+// follows the edge and then always the best covered successor until target, a dead end or back at the start,
+// stops after maxLength + 1 edges at most
+Branch walkStrongest(const DeBruijnGraph& graph, const std::size_t start, std::uint8_t base, const std::size_t target,
+                     const std::size_t maxLength) {
+    Branch branch;
+    std::size_t node = start;
+    while (true) {
+        branch.edges.push_back({node, base});
+        branch.coverage += graph.multiplicity(node, base);
+        node = graph.successor(node, base);
+        if (branch.edges.size() > maxLength || node == target || node == start || successors(graph, node) == 0)
+            break;
+        base = successorBase(graph, node);
+        for (std::uint8_t next = base + 1; next < 4; next++) {
+            if (graph.multiplicity(node, next) > graph.multiplicity(node, base))
+                base = next;
+        }
+    }
+    branch.end = node;
+    return branch;
+}
+
+std::size_t medianMultiplicity(const DeBruijnGraph& graph) {
+    std::vector<std::size_t> counts;
+    counts.reserve(graph.edgeCount());
+    for (std::size_t node = 0; node < graph.nodeCount(); node++) {
+        for (std::uint8_t base = 0; base < 4; base++) {
+            if (graph.multiplicity(node, base) > 0)
+                counts.push_back(graph.multiplicity(node, base));
+        }
+    }
+    if (counts.empty())
+        return 0;
+    std::nth_element(counts.begin(), counts.begin() + counts.size() / 2, counts.end());
+    return counts[counts.size() / 2];
+}
+
+// mean coverage of a is below the one of b
+bool weaker(const Branch& a, const Branch& b) { return a.coverage * b.edges.size() < b.coverage * a.edges.size(); }
+
+std::size_t removeBranch(DeBruijnGraph& graph, const Branch& branch) {
+    for (const Edge& edge : branch.edges) {
+        graph.removeEdge(edge.from, edge.base);
+    }
+    return branch.edges.size();
+}
+
+}  // namespace
+
+DeBruijnGraph buildFiltered(const std::size_t k, const std::vector<std::string>& reads,
+                            const CleaningOptions& options) {
+    if (k == 0 || k > maxPackedK)
+        throw std::invalid_argument("error-tolerant construction needs 0 < k <= " + std::to_string(maxPackedK));
+    CountMinSketch sketch(options.sketchWidth, options.sketchDepth);
+    for (const auto& read : reads) {
+        forEachKmer(read, k + 1, [&](Kmer edge) { sketch.add(edge); });
+    }
+    DeBruijnGraph graph(k);
+    for (const auto& read : reads) {
+        forEachKmer(read, k + 1, [&](Kmer edge) {
+            if (sketch.count(edge) >= options.minAbundance)
+                graph.addEdge(edge);
+        });
+    }
+    return graph;
+}
+
+std::size_t removeTips(DeBruijnGraph& graph, const std::size_t maxLength) {
+    const std::size_t median = medianMultiplicity(graph);
+    std::size_t removed      = 0;
+    std::size_t round        = 0;
+    do {
+        round = 0;
+        for (std::size_t node = 0; node < graph.nodeCount(); node++) {
+            if (predecessors(graph, node) == 0 && successors(graph, node) == 1) {
+                Branch tip = walkForward(graph, node, successorBase(graph, node), maxLength);
+                if (tip.edges.size() > maxLength)
+                    continue;
+                if (successors(graph, tip.end) == 0 && predecessors(graph, tip.end) == 1) {
+                    // a short chain joining nothing, left by an error repeated in a few reads
+                    if (2 * tip.coverage < median * tip.edges.size())
+                        round += removeBranch(graph, tip);
+                } else if (predecessors(graph, tip.end) > 1) {
+                    std::size_t strongest = 0;
+                    for (std::uint8_t base = 0; base < 4; base++) {
+                        if (graph.predecessor(tip.end, base) != tip.edges.back().from)
+                            strongest = std::max(strongest, inMultiplicity(graph, tip.end, base));
+                    }
+                    if (tip.coverage < strongest * tip.edges.size())
+                        round += removeBranch(graph, tip);
+                }
+            } else if (successors(graph, node) == 0 && predecessors(graph, node) == 1) {
+                Branch tip = walkBackward(graph, node, maxLength);
+                if (tip.edges.size() <= maxLength && successors(graph, tip.end) > 1) {
+                    std::size_t strongest = 0;
+                    for (std::uint8_t base = 0; base < 4; base++) {
+                        if (base != tip.edges.back().base)
+                            strongest = std::max(strongest, graph.multiplicity(tip.end, base));
+                    }
+                    if (tip.coverage < strongest * tip.edges.size())
+                        round += removeBranch(graph, tip);
+                }
+            }
+        }
+        removed += round;
+    } while (round > 0);
+    return removed;
+}
+
+std::size_t popBubbles(DeBruijnGraph& graph, const std::size_t maxLength) {
+    std::size_t removed = 0;
+    for (std::size_t node = 0; node < graph.nodeCount(); node++) {
+        if (successors(graph, node) < 2)
+            continue;
+        for (std::uint8_t base = 0; base < 4; base++) {
+            if (graph.multiplicity(node, base) == 0)
+                continue;
+            Branch branch = walkForward(graph, node, base, maxLength);
+            if (branch.edges.size() > maxLength || branch.end == node)
+                continue;
+            // the other side of the bubble may branch itself where errors of other reads leave bubbles
+            // overlapping this one, so it follows the best covered edges instead of a chain
+            for (std::uint8_t other = 0; other < 4; other++) {
+                if (other == base || graph.multiplicity(node, other) == 0)
+                    continue;
+                Branch alternative = walkStrongest(graph, node, other, branch.end, maxLength);
+                if (alternative.end == branch.end && alternative.edges.size() <= maxLength &&
+                    !weaker(alternative, branch)) {
+                    removed += removeBranch(graph, branch);
+                    break;
+                }
+            }
+        }
+    }
+    return removed;
+}
+
+void normalizeCoverage(DeBruijnGraph& graph, std::size_t coverage) {
+    if (coverage == 0)
+        coverage = medianMultiplicity(graph);
+    if (coverage == 0)
+        return;
+    auto copies = [&](std::size_t count, std::size_t edges) {
+        return std::max<std::size_t>(1, (2 * count + coverage * edges) / (2 * coverage * edges));
+    };
+    // every edge of a chain is in the genome as often as the others, so the chain gets the copy number
+    // of its mean count, single edges counted a few times too often or too rarely would unbalance the path
+    std::vector<bool> inChain(graph.nodeCount());
+    for (std::size_t node = 0; node < graph.nodeCount(); node++) {
+        if (isChain(graph, node))
+            continue;
+        for (std::uint8_t base = 0; base < 4; base++) {
+            if (graph.multiplicity(node, base) == 0)
+                continue;
+            Branch chain = walkForward(graph, node, base, graph.nodeCount());
+            for (const Edge& edge : chain.edges) {
+                inChain[edge.from] = true;
+                graph.setMultiplicity(edge.from, edge.base, copies(chain.coverage, chain.edges.size()));
+            }
+        }
+    }
+    // what is left are cycles without a branch
+    for (std::size_t node = 0; node < graph.nodeCount(); node++) {
+        for (std::uint8_t base = 0; base < 4 && !inChain[node]; base++) {
+            std::size_t count = graph.multiplicity(node, base);
+            if (count > 0)
+                graph.setMultiplicity(node, base, copies(count, 1));
+        }
+    }
+}
+
+std::string assembly(const std::size_t k, const std::vector<std::string>& reads, const CleaningOptions& options) {
+    if (k == 0 || reads.empty())
+        return "";
+    DeBruijnGraph graph            = buildFiltered(k, reads, options);
+    const std::size_t tipLength    = options.maxTipLength ? options.maxTipLength : 2 * k;
+    const std::size_t bubbleLength = options.maxBubbleLength ? options.maxBubbleLength : k + 1;
+    while (removeTips(graph, tipLength) + popBubbles(graph, bubbleLength) > 0) {
+    }
+    normalizeCoverage(graph, options.coverage);
+    return assembly(graph);
+}
+
+}  // namespace genome
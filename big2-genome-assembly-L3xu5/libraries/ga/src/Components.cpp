@@ -0,0 +1,100 @@
+#include "ga/Components.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory_resource>
+
+#include "ga/Genome.hpp"
+#include "ga/Parallel.hpp"
+#include "ga/Unitig.hpp"
+
+namespace genome {
+
+namespace {
+
+class ConcurrentUnionFind {
+public:
+    explicit ConcurrentUnionFind(const std::size_t size) : parent(size) {
+        for (std::size_t i = 0; i < size; i++) {
+            parent[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    std::size_t find(std::size_t node) {
+        while (true) {
+            std::size_t up = parent[node].load(std::memory_order_acquire);
+            if (up == node)
+                return node;
+            // path halving, losing the race only means the path stays longer
+            std::size_t grand = parent[up].load(std::memory_order_acquire);
+            parent[node].compare_exchange_weak(up, grand, std::memory_order_release, std::memory_order_relaxed);
+            node = grand;
+        }
+    }
+
+    // roots only ever get linked below smaller roots, so the final root is the smallest node
+    void unite(std::size_t a, std::size_t b) {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+            if (a < b)
+                std::swap(a, b);
+            std::size_t expected = a;
+            if (parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel))
+                return;
+        }
+    }
+
+private:
+    std::vector<std::atomic<std::size_t>> parent;
+};
+
+}  // namespace
+
+std::vector<std::size_t> components(const DeBruijnGraph& graph, const std::size_t threads) {
+    const std::size_t nodes = graph.nodeCount();
+    ConcurrentUnionFind sets(nodes);
+    constexpr std::size_t blockSize = 1 << 14;
+    parallelFor((nodes + blockSize - 1) / blockSize, threads, [&](std::size_t block) {
+        for (std::size_t node = block * blockSize; node < std::min(nodes, (block + 1) * blockSize); node++) {
+            for (std::uint8_t base = 0; base < 4; base++) {
+                if (graph.multiplicity(node, base) > 0)
+                    sets.unite(node, graph.successor(node, base));
+            }
+        }
+    });
+    std::vector<std::size_t> result(nodes);
+    for (std::size_t node = 0; node < nodes; node++) {
+        result[node] = sets.find(node);
+    }
+    return result;
+}
+
+std::vector<std::string> parallelContigs(const DeBruijnGraph& graph, const std::size_t threads) {
+    const std::vector<std::size_t> roots = components(graph, threads);
+    // a root is the smallest node of its component, so numbering roots in node order is deterministic
+    std::vector<std::size_t> index(roots.size(), DeBruijnGraph::npos);
+    std::vector<std::vector<std::size_t>> members;
+    for (std::size_t node = 0; node < roots.size(); node++) {
+        if (roots[node] == node) {
+            index[node] = members.size();
+            members.emplace_back();
+        }
+        members[index[roots[node]]].push_back(node);
+    }
+    std::vector<std::vector<std::string>> parts(members.size());
+    parallelFor(members.size(), threads, [&](std::size_t i) {
+        std::pmr::monotonic_buffer_resource arena;
+        parts[i] = contigs(UnitigGraph(subgraph(graph, members[i], &arena)));
+    });
+    std::vector<std::string> result;
+    for (auto& part : parts) {
+        std::move(part.begin(), part.end(), std::back_inserter(result));
+    }
+    return result;
+}
+
+}  // namespace genome
@@ -1,7 +1,15 @@
 #include "ga/Genome.hpp"
 
+#include <algorithm>
+#include <array>
+#include <memory_resource>
+#include <stdexcept>
 #include <unordered_map>
 
+#include "ga/Graph.hpp"
+#include "ga/Kmer.hpp"
+#include "ga/Unitig.hpp"
+
 namespace std {
 
 template <>
@@ -17,9 +25,9 @@ struct hash<pair<size_t, size_t>> {
 
 namespace genome {
 
-std::vector<std::size_t> findWay(const std::size_t& start,
-                                 std::unordered_map<std::size_t, std::unordered_map<std::size_t, std::size_t>>& g,
-                                 const std::size_t& graphSize) {
+using Adjacency = std::pmr::unordered_map<std::size_t, std::pmr::unordered_map<std::size_t, std::size_t>>;
+
+std::vector<std::size_t> findWay(const std::size_t& start, Adjacency& g, const std::size_t& graphSize) {
     std::unordered_map<std::size_t, std::unordered_map<std::pair<std::size_t, std::size_t>, std::size_t>> triedOnStep;
     std::vector<std::size_t> way;
     way.push_back(start);
@@ -57,14 +65,177 @@ std::vector<std::size_t> findWay(const std::size_t& start,
     return way;
 }
 
+namespace {
+
+bool fitsPacked(size_t k, const std::vector<std::string>& input) {
+    if (k > maxPackedK)
+        return false;
+    for (const auto& gen : input) {
+        if (!isPackable(gen))
+            return false;
+    }
+    return true;
+}
+
+std::string packedAssembly(size_t k, const std::vector<std::string>& input) {
+    std::pmr::monotonic_buffer_resource arena;
+    DeBruijnGraph graph(k, &arena);
+    for (const auto& gen : input) {
+        graph.addRead(gen);
+    }
+    return assembly(graph);
+}
+
+// Eulerian path over the unitigs and the number of bases it spells, 0 if there is no start node
+struct Walk {
+    std::size_t start = 0;
+    std::vector<std::size_t> way;
+    std::size_t length = 0;
+};
+
+constexpr std::size_t chunkSize = 1 << 16;
+
+// on both strands an end k-mer which is its own reverse complement is entered by the twin of the edge
+// leaving it, so it looks balanced; such a node with the fewest edges is the start then
+std::size_t palindromicStart(const UnitigGraph& unitigs) {
+    std::size_t start = DeBruijnGraph::npos;
+    for (std::size_t node = 0; node < unitigs.nodeCount(); node++) {
+        const Kmer kmer = unitigs.kmer(node);
+        if (unitigs.outDegree(node) > 0 && kmer == reverseComplement(kmer, unitigs.k()) &&
+            (start == DeBruijnGraph::npos || unitigs.outDegree(node) < unitigs.outDegree(start)))
+            start = node;
+    }
+    return start;
+}
+
+Walk findWalk(const UnitigGraph& unitigs) {
+    Walk walk;
+    std::size_t start = DeBruijnGraph::npos;
+    for (std::size_t node = 0; node < unitigs.nodeCount() && start == DeBruijnGraph::npos; node++) {
+        if (unitigs.outDegree(node) > unitigs.inDegree(node))
+            start = node;
+    }
+    if (start == DeBruijnGraph::npos && unitigs.doubleStranded())
+        start = palindromicStart(unitigs);
+    if (start == DeBruijnGraph::npos)
+        return walk;
+    walk.start  = start;
+    walk.way    = findWay(unitigs, start);
+    walk.length = unitigs.k();
+    for (std::size_t step : walk.way) {
+        walk.length += unitigs.unitigs()[step].length;
+    }
+    return walk;
+}
+
+// out must hold walk.length chars
+void spell(const UnitigGraph& unitigs, const Walk& walk, char* out) {
+    if (walk.length == 0)
+        return;
+    unpackKmer(unitigs.kmer(walk.start), unitigs.k(), out);
+    out += unitigs.k();
+    for (std::size_t step : walk.way) {
+        const Unitig& unitig = unitigs.unitigs()[step];
+        unitigs.bases().decode(unitig.offset, unitig.length, out);
+        out += unitig.length;
+    }
+}
+
+}  // namespace
+
+std::string assembly(const DeBruijnGraph& graph) { return assembly(UnitigGraph(graph)); }
+
+std::string assembly(const UnitigGraph& unitigs) {
+    Walk walk = findWalk(unitigs);
+    std::string result(walk.length, 'A');
+    spell(unitigs, walk, result.data());
+    return result;
+}
+
+std::size_t assembly(const UnitigGraph& unitigs, std::ostream& out) {
+    Walk walk = findWalk(unitigs);
+    if (walk.length == 0)
+        return 0;
+    std::array<char, chunkSize> chunk;
+    unpackKmer(unitigs.kmer(walk.start), unitigs.k(), chunk.data());
+    out.write(chunk.data(), static_cast<std::streamsize>(unitigs.k()));
+    for (std::size_t step : walk.way) {
+        const Unitig& unitig = unitigs.unitigs()[step];
+        for (std::size_t i = 0; i < unitig.length; i += chunkSize) {
+            std::size_t count = std::min(chunkSize, unitig.length - i);
+            unitigs.bases().decode(unitig.offset + i, count, chunk.data());
+            out.write(chunk.data(), static_cast<std::streamsize>(count));
+        }
+    }
+    return walk.length;
+}
+
+std::size_t assembly(const UnitigGraph& unitigs, std::span<char> buffer) {
+    Walk walk = findWalk(unitigs);
+    if (walk.length <= buffer.size())
+        spell(unitigs, walk, buffer.data());
+    return walk.length;
+}
+
+std::vector<std::string> contigs(const UnitigGraph& unitigs) {
+    std::vector<std::string> result;
+    result.reserve(unitigs.unitigs().size());
+    for (std::size_t i = 0; i < unitigs.unitigs().size(); i++) {
+        if (unitigs.doubleStranded() && unitigs.twin(i) < i)
+            continue;
+        const Unitig& unitig = unitigs.unitigs()[i];
+        std::string& contig  = result.emplace_back(unitigs.k() + unitig.length, 'A');
+        unpackKmer(unitigs.kmer(unitig.from), unitigs.k(), contig.data());
+        unitigs.bases().decode(unitig.offset, unitig.length, contig.data() + unitigs.k());
+    }
+    return result;
+}
+
+std::vector<std::string> contigs(const size_t k, const std::vector<std::string>& reads) {
+    // as in assembly, k = 0 spells nothing
+    if (k == 0)
+        return {};
+    if (k > maxPackedK)
+        throw std::invalid_argument("contigs need k <= " + std::to_string(maxPackedK));
+    std::pmr::monotonic_buffer_resource arena;
+    DeBruijnGraph graph(k, &arena);
+    for (const auto& read : reads) {
+        forEachKmer(read, k + 1, [&](Kmer edge) { graph.addEdge(edge); });
+    }
+    return contigs(UnitigGraph(graph));
+}
+
+std::string assembly(size_t k, const std::vector<std::string>& reads, const GraphBackend backend) {
+    if (backend == GraphBackend::Exact)
+        return assembly(k, reads);
+    if (k == 0 || reads.empty())
+        return "";
+    if (backend == GraphBackend::Bloom)
+        return assembly(UnitigGraph(BloomGraph(k, reads)));
+    if (backend == GraphBackend::Sorted)
+        return assembly(UnitigGraph(SortedGraph(k, reads)));
+    if (k > maxPackedK)
+        throw std::invalid_argument("canonical k-mers need k <= " + std::to_string(maxPackedK));
+    std::pmr::monotonic_buffer_resource arena;
+    CanonicalGraph graph(k, &arena);
+    for (const auto& read : reads) {
+        graph.addRead(read);
+    }
+    return assembly(UnitigGraph(graph));
+}
+
 std::string assembly(size_t k, const std::vector<std::string>& input) {
     if (k == 0 || input.empty())
         return "";
-    std::unordered_map<std::size_t, std::unordered_map<std::size_t, std::size_t>> g;
+    if (fitsPacked(k, input))
+        return packedAssembly(k, input);
+    // every map entry comes from the arena and is released at once on return
+    std::pmr::monotonic_buffer_resource arena;
+    Adjacency g(&arena);
     std::size_t graphSize = 1;
-    std::unordered_map<std::size_t, int> inOutEdgesDiff;
+    std::pmr::unordered_map<std::size_t, int> inOutEdgesDiff(&arena);
     std::hash<std::string_view> hasher;
-    std::unordered_map<std::size_t, std::string> names;
+    std::pmr::unordered_map<std::size_t, std::pmr::string> names(&arena);
     for (auto gen : input) {
         for (size_t i = k; i < gen.size(); i++) {
             std::string_view cur      = std::string_view(gen).substr(i - k, k + 1);
@@ -91,9 +262,10 @@ std::string assembly(size_t k, const std::vector<std::string>& input) {
     for (auto [node, _] : g) {
         if (inOutEdgesDiff[node] > 0) {
             std::vector<std::size_t> way = findWay(node, g, graphSize);
-            result                       = names[node].substr(0, k - 1);
+            result.reserve(k - 1 + way.size());
+            result = std::string_view(names[node]).substr(0, k - 1);
             for (std::size_t step : way) {
-                result += names[step].substr(k - 1);
+                result.push_back(names[step].back());
             }
             break;
         }
@@ -0,0 +1,152 @@
+#include "ga/Graph.hpp"
+
+namespace genome {
+
+DeBruijnGraph::DeBruijnGraph(const std::size_t k) : DeBruijnGraph(k, std::pmr::get_default_resource()) {}
+
+DeBruijnGraph::DeBruijnGraph(const std::size_t k, std::pmr::memory_resource* arena) : kmerSize(k), index(arena) {}
+
+std::size_t DeBruijnGraph::addNode(const Kmer kmer) {
+    auto [it, inserted] = index.try_emplace(kmer, nodes.size());
+    if (inserted)
+        nodes.push_back(Node{kmer});
+    return it->second;
+}
+
+void DeBruijnGraph::addRead(std::string_view read) {
+    std::array<std::uint8_t, blockBases> codes;
+    Kmer cur          = 0;
+    Kmer prev         = 0;
+    std::size_t valid = 0;
+    std::size_t from  = npos;
+    for (std::size_t start = 0; start < read.size(); start += blockBases) {
+        const std::size_t count = std::min(blockBases, read.size() - start);
+        std::uint64_t invalid   = encodeBlock(read.data() + start, count, codes.data());
+        for (std::size_t i = 0; i < count; i++) {
+            if ((invalid >> i) & 1) {
+                valid = 0;
+                from  = npos;
+                continue;
+            }
+            cur = appendBase(cur, codes[i], kmerSize);
+            // nodes are added with their first edge only, a run of k bases adds nothing
+            if (++valid > kmerSize) {
+                if (from == npos)
+                    from = addNode(prev);
+                std::size_t to = addNode(cur);
+                nodes[from].out[codes[i]]++;
+                nodes[to].in++;
+                edges++;
+                from = to;
+            }
+            prev = cur;
+        }
+    }
+}
+
+void DeBruijnGraph::addEdge(const Kmer edge, const std::size_t multiplicity) {
+    std::size_t from = addNode(edge >> 2);
+    std::size_t to   = addNode(edge & kmerMask(kmerSize));
+    nodes[from].out[lastBase(edge)] += multiplicity;
+    nodes[to].in += multiplicity;
+    edges += multiplicity;
+}
+
+void DeBruijnGraph::setMultiplicity(const std::size_t node, const std::uint8_t base, const std::size_t multiplicity) {
+    std::size_t& count = nodes[node].out[base];
+    if (count == multiplicity)
+        return;
+    Node& to = nodes[successor(node, base)];
+    to.in    = to.in - count + multiplicity;
+    edges    = edges - count + multiplicity;
+    count    = multiplicity;
+}
+
+void DeBruijnGraph::merge(const DeBruijnGraph& other) {
+    for (const Node& node : other.nodes) {
+        Node& target = nodes[addNode(node.kmer)];
+        for (std::uint8_t base = 0; base < 4; base++) {
+            target.out[base] += node.out[base];
+        }
+        target.in += node.in;
+    }
+    edges += other.edges;
+}
+
+std::size_t DeBruijnGraph::find(const Kmer kmer) const {
+    auto it = index.find(kmer);
+    return it == index.end() ? npos : it->second;
+}
+
+std::size_t DeBruijnGraph::outDegree(const std::size_t node) const {
+    std::size_t degree = 0;
+    for (std::size_t count : nodes[node].out) {
+        degree += count;
+    }
+    return degree;
+}
+
+DeBruijnGraph subgraph(const DeBruijnGraph& graph, const std::vector<std::size_t>& nodes,
+                       std::pmr::memory_resource* arena) {
+    DeBruijnGraph part(graph.k(), arena);
+    for (std::size_t node : nodes) {
+        for (std::uint8_t base = 0; base < 4; base++) {
+            if (std::size_t count = graph.multiplicity(node, base))
+                part.addEdge((graph.kmer(node) << 2) | base, count);
+        }
+    }
+    return part;
+}
+
+CanonicalGraph::CanonicalGraph(const std::size_t k) : CanonicalGraph(k, std::pmr::get_default_resource()) {}
+
+CanonicalGraph::CanonicalGraph(const std::size_t k, std::pmr::memory_resource* arena) : kmerSize(k), index(arena) {}
+
+std::size_t CanonicalGraph::addNode(const Kmer kmer) {
+    CanonicalKmer key    = canonical(kmer, kmerSize);
+    auto [it, inserted] = index.try_emplace(key.kmer, entries.size());
+    if (inserted)
+        entries.push_back(Entry{key.kmer});
+    return 2 * it->second + (key.reversed ? 1 : 0);
+}
+
+std::size_t CanonicalGraph::find(const Kmer kmer) const {
+    CanonicalKmer key = canonical(kmer, kmerSize);
+    auto it           = index.find(key.kmer);
+    return it == index.end() ? npos : 2 * it->second + (key.reversed ? 1 : 0);
+}
+
+void CanonicalGraph::addArc(const std::size_t from, const std::uint8_t base) {
+    entries[from / 2].out[from % 2][base]++;
+}
+
+void CanonicalGraph::addEdge(const Kmer edge) {
+    Kmer twin = reverseComplement(edge, kmerSize + 1);
+    addArc(addNode(edge >> 2), lastBase(edge));
+    addNode(edge & kmerMask(kmerSize));
+    // a palindromic edge is its own reverse complement
+    if (twin != edge)
+        addArc(addNode(twin >> 2), lastBase(twin));
+    edges++;
+}
+
+void CanonicalGraph::addRead(std::string_view read) {
+    forEachKmer(read, kmerSize + 1, [&](Kmer edge) { addEdge(edge); });
+}
+
+std::size_t CanonicalGraph::outDegree(const std::size_t node) const {
+    std::size_t degree = 0;
+    for (std::size_t count : entries[node / 2].out[node % 2]) {
+        degree += count;
+    }
+    return degree;
+}
+
+std::size_t CanonicalGraph::inDegree(const std::size_t node) const {
+    // an edge entering node is the twin of one leaving its reverse complement, which for
+    // a palindromic k-mer is the node itself
+    const Kmer kmer = entries[node / 2].kmer;
+    return outDegree(kmer == reverseComplement(kmer, kmerSize) ? node : node ^ 1);
+}
+
+}  // namespace genome
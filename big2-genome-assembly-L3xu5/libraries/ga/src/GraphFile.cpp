@@ -0,0 +1,213 @@
+#include "ga/GraphFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace genome {
+
+namespace {
+
+constexpr std::array<char, 8> magic     = {'G', 'A', 'G', 'R', 'A', 'P', 'H', '\0'};
+constexpr std::uint64_t byteOrderMark = 0x0102030405060708ULL;
+
+struct Header {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t k;
+    std::uint64_t byteOrder;
+    std::uint64_t nodes;
+    std::uint64_t arcs;
+    std::uint64_t edges;
+};
+
+static_assert(sizeof(Header) % sizeof(std::uint64_t) == 0);
+
+std::size_t fileSize(const Header& header) {
+    return sizeof(Header) + (4 * header.nodes + 1 + 2 * header.arcs) * sizeof(std::uint64_t);
+}
+
+void write(std::ofstream& out, const std::vector<std::uint64_t>& values) {
+    out.write(reinterpret_cast<const char*>(values.data()),
+              static_cast<std::streamsize>(values.size() * sizeof(std::uint64_t)));
+}
+
+}  // namespace
+
+void saveGraph(const DeBruijnGraph& graph, const std::filesystem::path& path) {
+    const std::size_t n = graph.nodeCount();
+    std::vector<std::uint64_t> kmers(n);
+    std::vector<std::uint64_t> in(n);
+    std::vector<std::uint64_t> offsets{0};
+    std::vector<std::uint64_t> targets;
+    std::vector<std::uint64_t> multiplicities;
+    for (std::size_t node = 0; node < n; node++) {
+        kmers[node] = graph.kmer(node);
+        in[node]    = graph.inDegree(node);
+        for (std::uint8_t base = 0; base < 4; base++) {
+            if (std::size_t count = graph.multiplicity(node, base)) {
+                targets.push_back(graph.successor(node, base));
+                multiplicities.push_back(count);
+            }
+        }
+        offsets.push_back(targets.size());
+    }
+    std::vector<std::uint64_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](auto a, auto b) { return kmers[a] < kmers[b]; });
+
+    Header header{magic, graphFileVersion, static_cast<std::uint32_t>(graph.k()), byteOrderMark, n, targets.size(),
+                  graph.edgeCount()};
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto* values : {&kmers, &in, &offsets, &targets, &multiplicities, &order}) {
+        write(out, *values);
+    }
+    if (!out)
+        throw std::runtime_error("cannot write graph file " + path.string());
+}
+
+void saveGraph(const std::size_t k, const std::size_t nodes, const std::size_t arcs, const std::size_t edges,
+               const GraphArrayFiles& arrays, const std::filesystem::path& path) {
+    Header header{magic, graphFileVersion, static_cast<std::uint32_t>(k), byteOrderMark, nodes, arcs, edges};
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto* array : {&arrays.kmers, &arrays.in, &arrays.offsets, &arrays.targets, &arrays.multiplicities}) {
+        std::ifstream in(*array, std::ios::binary);
+        if (!in)
+            throw std::runtime_error("cannot read " + array->string());
+        // an empty array leaves nothing to copy, which would set failbit on out
+        if (in.peek() != std::ifstream::traits_type::eof())
+            out << in.rdbuf();
+    }
+    std::vector<std::uint64_t> order;
+    for (std::size_t node = 0; node < nodes;) {
+        order.clear();
+        for (; node < nodes && order.size() < 4096; node++) {
+            order.push_back(node);
+        }
+        write(out, order);
+    }
+    if (!out || static_cast<std::size_t>(out.tellp()) != fileSize(header))
+        throw std::runtime_error("cannot write graph file " + path.string());
+}
+
+MappedGraph::MappedGraph(const std::filesystem::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open graph file " + path.string());
+    struct stat status {};
+    if (::fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) >= sizeof(Header)) {
+        bytes   = static_cast<std::size_t>(status.st_size);
+        mapping = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == nullptr || mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("cannot map graph file " + path.string());
+    }
+    Header header;
+    std::memcpy(&header, mapping, sizeof(header));
+    // counts larger than the file would wrap around in fileSize and could match its size
+    const std::size_t words = bytes / sizeof(std::uint64_t);
+    if (header.magic != magic || header.version != graphFileVersion || header.byteOrder != byteOrderMark ||
+        header.nodes > words || header.arcs > words || fileSize(header) != bytes) {
+        ::munmap(mapping, bytes);
+        throw std::runtime_error("not a version " + std::to_string(graphFileVersion) + " graph file " +
+                                 path.string());
+    }
+    kmerSize       = header.k;
+    nodes          = header.nodes;
+    edges          = header.edges;
+    kmers          = reinterpret_cast<const std::uint64_t*>(static_cast<const char*>(mapping) + sizeof(Header));
+    in             = kmers + nodes;
+    offsets        = in + nodes;
+    targets        = offsets + nodes + 1;
+    multiplicities = targets + header.arcs;
+    order          = multiplicities + header.arcs;
+    // the queries index with these values unchecked, so a damaged file must not get past here
+    const char* damage = nullptr;
+    if (kmerSize == 0 || kmerSize > maxPackedK)
+        damage = "k out of range";
+    else if (offsets[0] != 0 || offsets[nodes] != header.arcs)
+        damage = "arc offsets do not span the arcs";
+    else if (!std::is_sorted(offsets, offsets + nodes + 1))
+        damage = "arc offsets are not monotone";
+    else if (std::any_of(targets, targets + header.arcs, [&](std::uint64_t target) { return target >= nodes; }))
+        damage = "arc target out of range";
+    else if (std::any_of(order, order + nodes, [&](std::uint64_t node) { return node >= nodes; }))
+        damage = "node order out of range";
+    if (damage != nullptr) {
+        ::munmap(mapping, bytes);
+        mapping = nullptr;
+        throw std::runtime_error("damaged graph file " + path.string() + ": " + damage);
+    }
+}
+
+MappedGraph::MappedGraph(MappedGraph&& other) noexcept
+    : mapping(std::exchange(other.mapping, nullptr)),
+      bytes(other.bytes),
+      kmerSize(other.kmerSize),
+      nodes(other.nodes),
+      edges(other.edges),
+      kmers(other.kmers),
+      in(other.in),
+      offsets(other.offsets),
+      targets(other.targets),
+      multiplicities(other.multiplicities),
+      order(other.order) {}
+
+MappedGraph::~MappedGraph() {
+    if (mapping != nullptr)
+        ::munmap(mapping, bytes);
+}
+
+std::size_t MappedGraph::find(const Kmer kmer) const {
+    const std::uint64_t* it =
+        std::lower_bound(order, order + nodes, kmer, [&](std::uint64_t node, Kmer key) { return kmers[node] < key; });
+    return it != order + nodes && kmers[*it] == kmer ? *it : npos;
+}
+
+std::size_t MappedGraph::arc(const std::size_t node, const std::uint8_t base) const {
+    std::size_t i = offsets[node];
+    while (i < offsets[node + 1] && lastBase(kmers[targets[i]]) != base) {
+        i++;
+    }
+    return i;
+}
+
+std::size_t MappedGraph::multiplicity(const std::size_t node, const std::uint8_t base) const {
+    std::size_t i = arc(node, base);
+    return i < offsets[node + 1] ? multiplicities[i] : 0;
+}
+
+std::size_t MappedGraph::successor(const std::size_t node, const std::uint8_t base) const {
+    std::size_t i = arc(node, base);
+    return i < offsets[node + 1] ? targets[i] : npos;
+}
+
+std::size_t MappedGraph::outDegree(const std::size_t node) const {
+    return std::accumulate(multiplicities + offsets[node], multiplicities + offsets[node + 1], std::size_t{0});
+}
+
+DeBruijnGraph MappedGraph::toGraph() const {
+    DeBruijnGraph graph(kmerSize);
+    for (std::size_t node = 0; node < nodes; node++) {
+        for (std::size_t i = offsets[node]; i < offsets[node + 1]; i++) {
+            graph.addEdge((kmers[node] << 2) | lastBase(kmers[targets[i]]), multiplicities[i]);
+        }
+    }
+    return graph;
+}
+
+}  // namespace genome
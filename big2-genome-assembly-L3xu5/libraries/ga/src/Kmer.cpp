@@ -0,0 +1,126 @@
+#include "ga/Kmer.hpp"
+
+#include <algorithm>
+#include <array>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace genome {
+
+// A, C, G, T are 0x41, 0x43, 0x47, 0x54, so bits 1 and 2 of the letter are 0, 1, 3, 2,
+// and xoring in the upper of the two bits swaps G and T into 2 and 3
+std::uint64_t encodeBlock(const char* ascii, const std::size_t count, std::uint8_t* codes) {
+    std::uint64_t invalid = 0;
+    std::size_t i         = 0;
+#if defined(__AVX2__)
+    const __m256i a     = _mm256_set1_epi8('A');
+    const __m256i c     = _mm256_set1_epi8('C');
+    const __m256i g     = _mm256_set1_epi8('G');
+    const __m256i t     = _mm256_set1_epi8('T');
+    const __m256i three = _mm256_set1_epi8(3);
+    const __m256i one   = _mm256_set1_epi8(1);
+    for (; i + 32 <= count; i += 32) {
+        __m256i letters = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ascii + i));
+        __m256i valid   = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(letters, a), _mm256_cmpeq_epi8(letters, c)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(letters, g), _mm256_cmpeq_epi8(letters, t)));
+        __m256i code    = _mm256_and_si256(_mm256_srli_epi16(letters, 1), three);
+        code            = _mm256_xor_si256(code, _mm256_and_si256(_mm256_srli_epi16(code, 1), one));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(codes + i), code);
+        invalid |= static_cast<std::uint64_t>(~static_cast<std::uint32_t>(_mm256_movemask_epi8(valid))) << i;
+    }
+#elif defined(__SSE2__)
+    const __m128i a     = _mm_set1_epi8('A');
+    const __m128i c     = _mm_set1_epi8('C');
+    const __m128i g     = _mm_set1_epi8('G');
+    const __m128i t     = _mm_set1_epi8('T');
+    const __m128i three = _mm_set1_epi8(3);
+    const __m128i one   = _mm_set1_epi8(1);
+    for (; i + 16 <= count; i += 16) {
+        __m128i letters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ascii + i));
+        __m128i valid   = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(letters, a), _mm_cmpeq_epi8(letters, c)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(letters, g), _mm_cmpeq_epi8(letters, t)));
+        __m128i code    = _mm_and_si128(_mm_srli_epi16(letters, 1), three);
+        code            = _mm_xor_si128(code, _mm_and_si128(_mm_srli_epi16(code, 1), one));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + i), code);
+        invalid |= static_cast<std::uint64_t>(~_mm_movemask_epi8(valid) & 0xFFFF) << i;
+    }
+#endif
+    for (; i < count; i++) {
+        std::uint8_t code = encodeBase(ascii[i]);
+        codes[i]          = code & 3;
+        if (code == invalidBase)
+            invalid |= std::uint64_t{1} << i;
+    }
+    return invalid;
+}
+
+bool isPackable(std::string_view read) {
+    std::array<std::uint8_t, blockBases> codes;
+    for (std::size_t start = 0; start < read.size(); start += blockBases) {
+        if (encodeBlock(read.data() + start, std::min(blockBases, read.size() - start), codes.data()) != 0)
+            return false;
+    }
+    return true;
+}
+
+Kmer packKmer(std::string_view bases) {
+    Kmer kmer = 0;
+    for (char base : bases) {
+        kmer = (kmer << 2) | encodeBase(base);
+    }
+    return kmer;
+}
+
+std::string unpackKmer(const Kmer kmer, const std::size_t k) {
+    std::string bases(k, 'A');
+    unpackKmer(kmer, k, bases.data());
+    return bases;
+}
+
+void unpackKmer(Kmer kmer, const std::size_t k, char* out) {
+    for (std::size_t i = k; i > 0; i--) {
+        out[i - 1] = decodeBase(lastBase(kmer));
+        kmer >>= 2;
+    }
+}
+
+void PackedSequence::push_back(const std::uint8_t code) {
+    if (length % basesPerWord == 0)
+        words.push_back(0);
+    words.back() |= static_cast<std::uint64_t>(code & 3) << (2 * (length % basesPerWord));
+    length++;
+}
+
+void PackedSequence::decode(std::size_t first, const std::size_t count, char* out) const {
+    const std::size_t last = first + count;
+    while (first < last) {
+        std::uint64_t word = words[first / basesPerWord] >> (2 * (first % basesPerWord));
+        std::size_t n      = std::min(basesPerWord - first % basesPerWord, last - first);
+        for (std::size_t i = 0; i < n; i++) {
+            *out++ = decodeBase(word & 3);
+            word >>= 2;
+        }
+        first += n;
+    }
+}
+
+void PackedReads::add(std::string_view read) {
+    std::array<std::uint8_t, blockBases> codes;
+    forEachRun(read, [&](std::string_view run) {
+        for (std::size_t start = 0; start < run.size(); start += blockBases) {
+            std::size_t count = std::min(blockBases, run.size() - start);
+            encodeBlock(run.data() + start, count, codes.data());
+            for (std::size_t i = 0; i < count; i++) {
+                sequence.push_back(codes[i]);
+            }
+        }
+        ends.push_back(sequence.size());
+    });
+}
+
+}  // namespace genome
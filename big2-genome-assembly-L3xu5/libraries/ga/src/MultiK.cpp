@@ -0,0 +1,51 @@
+#include "ga/MultiK.hpp"
+
+#include <memory_resource>
+#include <stdexcept>
+
+#include "ga/Genome.hpp"
+#include "ga/Graph.hpp"
+#include "ga/Kmer.hpp"
+#include "ga/Unitig.hpp"
+
+namespace genome {
+
+namespace {
+
+// contigs are spelled from unitigs, so every edge counts once however often it was read
+void addDistinct(DeBruijnGraph& graph, const Kmer edge) {
+    std::size_t from = graph.find(edge >> 2);
+    if (from == DeBruijnGraph::npos || graph.multiplicity(from, lastBase(edge)) == 0)
+        graph.addEdge(edge);
+}
+
+}  // namespace
+
+std::vector<std::string> multiKContigs(const std::vector<std::string>& reads, const std::vector<std::size_t>& ks) {
+    if (ks.empty())
+        throw std::invalid_argument("multi-k assembly needs at least one k");
+    for (std::size_t i = 0; i < ks.size(); i++) {
+        if (ks[i] == 0 || ks[i] > maxPackedK || (i > 0 && ks[i] <= ks[i - 1]))
+            throw std::invalid_argument("multi-k assembly needs increasing ks in 0 < k <= " +
+                                        std::to_string(maxPackedK));
+    }
+    PackedReads packed;
+    for (const auto& read : reads) {
+        packed.add(read);
+    }
+    std::vector<std::string> result;
+    for (std::size_t k : ks) {
+        PackedReads pseudoReads;
+        for (const auto& contig : result) {
+            pseudoReads.add(contig);
+        }
+        std::pmr::monotonic_buffer_resource arena;
+        DeBruijnGraph graph(k, &arena);
+        packed.forEachKmer(k + 1, [&](Kmer edge) { addDistinct(graph, edge); });
+        pseudoReads.forEachKmer(k + 1, [&](Kmer edge) { addDistinct(graph, edge); });
+        result = contigs(UnitigGraph(graph));
+    }
+    return result;
+}
+
+}  // namespace genome
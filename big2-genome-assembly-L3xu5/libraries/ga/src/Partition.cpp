@@ -0,0 +1,470 @@
+#include "ga/Partition.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ga/Graph.hpp"
+#include "ga/Kmer.hpp"
+
+namespace genome {
+
+namespace {
+
+// rough footprint of one node of a bucket graph together with its index entry and run record
+constexpr std::size_t bytesPerKmer = 192;
+
+// parts an oversized bucket is split into at most at once
+constexpr std::size_t maxSplit = 64;
+
+// uniquely named directory for the files of one build, removed with all of them however the build ends
+class ScratchDirectory {
+public:
+    explicit ScratchDirectory(const std::filesystem::path& parent) {
+        std::string pattern = (parent / "ga-XXXXXX").string();
+        if (::mkdtemp(pattern.data()) == nullptr)
+            throw std::runtime_error("cannot create a scratch directory in " + parent.string());
+        root = pattern;
+    }
+
+    ScratchDirectory(const ScratchDirectory&)            = delete;
+    ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+    ~ScratchDirectory() {
+        std::error_code ignored;
+        std::filesystem::remove_all(root, ignored);
+    }
+
+    std::filesystem::path file(const std::string& name) const { return root / name; }
+
+private:
+    std::filesystem::path root;
+};
+
+// read-only mapping of a file of uint64_t values
+class MappedValues {
+public:
+    explicit MappedValues(const std::filesystem::path& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + path.string());
+        struct stat status {};
+        if (::fstat(fd, &status) == 0)
+            bytes = static_cast<std::size_t>(status.st_size);
+        if (bytes > 0)
+            mapping = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+            throw std::runtime_error("cannot map " + path.string());
+    }
+
+    MappedValues(const MappedValues&)            = delete;
+    MappedValues& operator=(const MappedValues&) = delete;
+
+    ~MappedValues() {
+        if (mapping != nullptr)
+            ::munmap(mapping, bytes);
+    }
+
+    const std::uint64_t* begin() const { return static_cast<const std::uint64_t*>(mapping); }
+
+    const std::uint64_t* end() const { return begin() + bytes / sizeof(std::uint64_t); }
+
+private:
+    void* mapping     = nullptr;
+    std::size_t bytes = 0;
+};
+
+// calls f(superKmer, minimizer) for every maximal run of (k + 1)-mers of the read sharing a minimizer;
+// neighbouring super-k-mers overlap by k bases, so every edge goes to exactly one of them.
+// m-mers are ordered by their hash, so that low-complexity ones such as AAAA...
+// do not collect most of the reads in one bucket
+template <class F>
+void forEachSuperKmer(std::string_view read, const std::size_t k, const std::size_t m, F&& f) {
+    const std::size_t window = k + 2 - m;
+    std::vector<std::uint64_t> orders(read.size() - m + 1);
+    Kmer mmer = 0;
+    for (std::size_t i = 0; i < read.size(); i++) {
+        mmer = appendBase(mmer, encodeBase(read[i]), m);
+        if (i + 1 >= m)
+            orders[i + 1 - m] = hashKmer(mmer);
+    }
+    std::deque<std::size_t> minima;
+    std::size_t start     = 0;
+    std::uint64_t current = 0;
+    for (std::size_t j = 0; j < orders.size(); j++) {
+        while (!minima.empty() && orders[minima.back()] >= orders[j]) {
+            minima.pop_back();
+        }
+        minima.push_back(j);
+        if (j + 1 < window)
+            continue;
+        std::size_t edge = j + 1 - window;
+        while (minima.front() < edge) {
+            minima.pop_front();
+        }
+        std::uint64_t order = orders[minima.front()];
+        if (edge == 0) {
+            current = order;
+        } else if (order != current) {
+            f(read.substr(start, edge + k - start), current);
+            start   = edge;
+            current = order;
+        }
+    }
+    f(read.substr(start), current);
+}
+
+// a super-k-mer record is its length, its minimizer order and its bases packed 4 per byte
+void writeSuperKmer(std::ofstream& out, std::string_view bases, const std::uint64_t order) {
+    std::uint32_t length = bases.size();
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.write(reinterpret_cast<const char*>(&order), sizeof(order));
+    unsigned char packed = 0;
+    for (std::size_t i = 0; i < bases.size(); i++) {
+        packed |= encodeBase(bases[i]) << (2 * (i % 4));
+        if (i % 4 == 3 || i + 1 == bases.size()) {
+            out.put(static_cast<char>(packed));
+            packed = 0;
+        }
+    }
+}
+
+bool readSuperKmer(std::ifstream& in, std::string& bases, std::uint64_t& order) {
+    std::uint32_t length = 0;
+    if (!in.read(reinterpret_cast<char*>(&length), sizeof(length)))
+        return false;
+    in.read(reinterpret_cast<char*>(&order), sizeof(order));
+    std::string packed((length + 3) / 4, '\0');
+    in.read(packed.data(), packed.size());
+    bases.resize(length);
+    for (std::size_t i = 0; i < length; i++) {
+        bases[i] = decodeBase(static_cast<unsigned char>(packed[i / 4]) >> (2 * (i % 4)));
+    }
+    return true;
+}
+
+void writeValue(std::ofstream& out, const std::uint64_t value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// a run is a file of (key, count) records sorted by key
+void writeRun(const std::filesystem::path& path, std::vector<std::pair<std::uint64_t, std::uint64_t>>& records) {
+    std::sort(records.begin(), records.end());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    for (const auto& [key, count] : records) {
+        writeValue(out, key);
+        writeValue(out, count);
+    }
+    if (!out)
+        throw std::runtime_error("cannot write " + path.string());
+}
+
+// calls f(key, count) for every key of the runs in increasing order, counts of a key summed over the runs;
+// only one record per run is held at a time
+template <class F>
+void mergeRuns(const std::vector<std::filesystem::path>& runs, F&& f) {
+    std::vector<std::ifstream> files;
+    std::vector<std::uint64_t> counts(runs.size());
+    using Head = std::pair<std::uint64_t, std::size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<>> heads;
+    auto advance = [&](const std::size_t run) {
+        std::uint64_t key = 0;
+        if (files[run].read(reinterpret_cast<char*>(&key), sizeof(key)) &&
+            files[run].read(reinterpret_cast<char*>(&counts[run]), sizeof(counts[run])))
+            heads.emplace(key, run);
+    };
+    for (std::size_t run = 0; run < runs.size(); run++) {
+        files.emplace_back(runs[run], std::ios::binary);
+        if (!files.back())
+            throw std::runtime_error("cannot read " + runs[run].string());
+        advance(run);
+    }
+    while (!heads.empty()) {
+        const std::uint64_t key = heads.top().first;
+        std::uint64_t count     = 0;
+        while (!heads.empty() && heads.top().first == key) {
+            const std::size_t run = heads.top().second;
+            heads.pop();
+            count += counts[run];
+            advance(run);
+        }
+        f(key, count);
+    }
+}
+
+struct Bucket {
+    std::size_t id;
+    std::size_t edges;
+    // cleared when splitting left it as big as its parent, all its edges then share one minimizer
+    bool splittable;
+};
+
+class BucketBuilder {
+public:
+    BucketBuilder(const std::size_t k, const DiskOptions& options, const ScratchDirectory& scratch)
+        : k(k), options(options), scratch(scratch) {}
+
+    std::filesystem::path bucketPath(const std::size_t id) const {
+        return scratch.file(std::to_string(id) + ".sk");
+    }
+
+    std::filesystem::path nodeRun(const std::size_t id) const { return scratch.file(std::to_string(id) + ".nodes"); }
+
+    std::filesystem::path edgeRun(const std::size_t id) const { return scratch.file(std::to_string(id) + ".edges"); }
+
+    std::size_t newId() { return nextId++; }
+
+    std::size_t footprint(const Bucket& bucket) const { return bucket.edges * bytesPerKmer; }
+
+    bool mustSplit(const Bucket& bucket) const {
+        return bucket.splittable && footprint(bucket) > options.memoryBudget;
+    }
+
+    // respreads the super-k-mers of the bucket over smaller ones by another hash of their minimizer
+    std::vector<Bucket> split(const Bucket& bucket) {
+        const std::size_t parts =
+            std::clamp<std::size_t>(2 * (footprint(bucket) / std::max<std::size_t>(options.memoryBudget, 1) + 1), 2,
+                                    maxSplit);
+        std::vector<Bucket> result;
+        std::vector<std::ofstream> files;
+        for (std::size_t part = 0; part < parts; part++) {
+            result.push_back(Bucket{newId(), 0, true});
+            files.emplace_back(bucketPath(result.back().id), std::ios::binary);
+            if (!files.back())
+                throw std::runtime_error("cannot create " + bucketPath(result.back().id).string());
+        }
+        {
+            std::ifstream in(bucketPath(bucket.id), std::ios::binary);
+            std::string superKmer;
+            std::uint64_t order = 0;
+            while (readSuperKmer(in, superKmer, order)) {
+                const std::size_t part = hashKmer(order, bucket.id + 1) % parts;
+                writeSuperKmer(files[part], superKmer, order);
+                result[part].edges += superKmer.size() - k;
+            }
+        }
+        std::filesystem::remove(bucketPath(bucket.id));
+        for (std::size_t part = 0; part < parts; part++) {
+            if (!files[part].flush())
+                throw std::runtime_error("cannot write " + bucketPath(result[part].id).string());
+            result[part].splittable = result[part].edges < bucket.edges;
+        }
+        return result;
+    }
+
+    // builds the graph of the bucket and writes its k-mers with their in-degrees and its edges
+    // with their multiplicities as runs; edges are (k + 1)-mers, so each one is in a single bucket
+    void build(const Bucket& bucket) {
+        std::pmr::monotonic_buffer_resource arena;
+        DeBruijnGraph part(k, &arena);
+        {
+            std::ifstream in(bucketPath(bucket.id), std::ios::binary);
+            std::string superKmer;
+            std::uint64_t order = 0;
+            while (readSuperKmer(in, superKmer, order)) {
+                part.addRead(superKmer);
+            }
+        }
+        std::filesystem::remove(bucketPath(bucket.id));
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> records;
+        records.reserve(part.nodeCount());
+        for (std::size_t node = 0; node < part.nodeCount(); node++) {
+            records.emplace_back(part.kmer(node), part.inDegree(node));
+        }
+        writeRun(nodeRun(bucket.id), records);
+        records.clear();
+        for (std::size_t node = 0; node < part.nodeCount(); node++) {
+            for (std::uint8_t base = 0; base < 4; base++) {
+                if (std::size_t count = part.multiplicity(node, base))
+                    records.emplace_back((part.kmer(node) << 2) | base, count);
+            }
+        }
+        writeRun(edgeRun(bucket.id), records);
+    }
+
+private:
+    std::size_t k;
+    const DiskOptions& options;
+    const ScratchDirectory& scratch;
+    std::atomic<std::size_t> nextId = 0;
+};
+
+}  // namespace
+
+MappedGraph buildOnDisk(const std::size_t k, std::istream& reads, const std::filesystem::path& graphFile,
+                        const DiskOptions& options) {
+    if (k == 0 || k > maxPackedK)
+        throw std::invalid_argument("disk-backed construction needs 0 < k <= " + std::to_string(maxPackedK));
+    const std::size_t m       = std::clamp<std::size_t>(options.minimizerSize, 1, k + 1);
+    const std::size_t buckets = std::max<std::size_t>(options.buckets, 1);
+    const ScratchDirectory scratch(options.directory);
+    BucketBuilder builder(k, options, scratch);
+
+    std::deque<Bucket> pending;
+    {
+        std::vector<std::ofstream> files;
+        for (std::size_t bucket = 0; bucket < buckets; bucket++) {
+            pending.push_back(Bucket{builder.newId(), 0, true});
+            files.emplace_back(builder.bucketPath(pending.back().id), std::ios::binary);
+            if (!files.back())
+                throw std::runtime_error("cannot create " + builder.bucketPath(pending.back().id).string());
+        }
+        for (std::string read; std::getline(reads, read);) {
+            forEachRun(read, [&](std::string_view run) {
+                if (run.size() <= k)
+                    return;
+                forEachSuperKmer(run, k, m, [&](std::string_view superKmer, std::uint64_t order) {
+                    std::size_t bucket = order % buckets;
+                    writeSuperKmer(files[bucket], superKmer, order);
+                    pending[bucket].edges += superKmer.size() - k;
+                });
+            });
+        }
+        for (std::size_t bucket = 0; bucket < buckets; bucket++) {
+            if (!files[bucket].flush())
+                throw std::runtime_error("cannot write " + builder.bucketPath(pending[bucket].id).string());
+        }
+    }
+
+    // workers take buckets in turn, splitting the oversized ones and building the others as far as the budget
+    // allows; the lock only guards this bookkeeping, the buckets are built and written out without it
+    std::vector<std::size_t> built;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::size_t inFlight = 0;
+    std::size_t busy     = 0;
+    std::exception_ptr error;
+    auto worker = [&] {
+        while (true) {
+            Bucket bucket{};
+            std::size_t footprint = 0;
+            bool splitting        = false;
+            {
+                std::unique_lock lock(mutex);
+                changed.wait(lock, [&] {
+                    if (error || pending.empty())
+                        return error || busy == 0;
+                    if (builder.mustSplit(pending.front()))
+                        return true;
+                    // a bucket larger than the whole budget is still built, but alone
+                    std::size_t next = builder.footprint(pending.front());
+                    return inFlight == 0 || inFlight + next <= options.memoryBudget;
+                });
+                if (error || pending.empty())
+                    return;
+                bucket = pending.front();
+                pending.pop_front();
+                splitting = builder.mustSplit(bucket);
+                footprint = splitting ? 0 : builder.footprint(bucket);
+                inFlight += footprint;
+                busy++;
+            }
+            try {
+                if (splitting) {
+                    std::vector<Bucket> parts = builder.split(bucket);
+                    std::lock_guard lock(mutex);
+                    pending.insert(pending.end(), parts.begin(), parts.end());
+                } else {
+                    builder.build(bucket);
+                    std::lock_guard lock(mutex);
+                    built.push_back(bucket.id);
+                }
+            } catch (...) {
+                std::lock_guard lock(mutex);
+                error = std::current_exception();
+            }
+            {
+                std::lock_guard lock(mutex);
+                inFlight -= footprint;
+                busy--;
+            }
+            changed.notify_all();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < options.threads; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error)
+        std::rethrow_exception(error);
+
+    // the node runs merge into the sorted k-mers, so a node is numbered by its rank
+    std::vector<std::filesystem::path> nodeRuns;
+    std::vector<std::filesystem::path> edgeRuns;
+    for (std::size_t id : built) {
+        nodeRuns.push_back(builder.nodeRun(id));
+        edgeRuns.push_back(builder.edgeRun(id));
+    }
+    const GraphArrayFiles arrays{scratch.file("kmers"), scratch.file("in"), scratch.file("offsets"),
+                                 scratch.file("targets"), scratch.file("multiplicities")};
+    std::size_t nodes = 0;
+    {
+        std::ofstream kmers(arrays.kmers, std::ios::binary | std::ios::trunc);
+        std::ofstream in(arrays.in, std::ios::binary | std::ios::trunc);
+        mergeRuns(nodeRuns, [&](std::uint64_t kmer, std::uint64_t inDegree) {
+            writeValue(kmers, kmer);
+            writeValue(in, inDegree);
+            nodes++;
+        });
+        if (!kmers.flush() || !in.flush())
+            throw std::runtime_error("cannot write the k-mers of " + graphFile.string());
+    }
+
+    // edges come sorted by their first k bases, i.e. by source node; targets are looked up in the mapped k-mers
+    std::size_t arcs  = 0;
+    std::size_t edges = 0;
+    {
+        const MappedValues kmers(arrays.kmers);
+        auto rank = [&](Kmer kmer) {
+            return static_cast<std::size_t>(std::lower_bound(kmers.begin(), kmers.end(), kmer) - kmers.begin());
+        };
+        std::size_t start = 0;
+        std::ofstream offsets(arrays.offsets, std::ios::binary | std::ios::trunc);
+        std::ofstream targets(arrays.targets, std::ios::binary | std::ios::trunc);
+        std::ofstream multiplicities(arrays.multiplicities, std::ios::binary | std::ios::trunc);
+        // offsets of the nodes up to and including last start at the next arc
+        auto startNodes = [&](std::size_t last) {
+            for (; start <= last; start++) {
+                writeValue(offsets, arcs);
+            }
+        };
+        mergeRuns(edgeRuns, [&](std::uint64_t edge, std::uint64_t count) {
+            startNodes(rank(edge >> 2));
+            writeValue(targets, rank(edge & kmerMask(k)));
+            writeValue(multiplicities, count);
+            arcs++;
+            edges += count;
+        });
+        startNodes(nodes);
+        if (!offsets.flush() || !targets.flush() || !multiplicities.flush())
+            throw std::runtime_error("cannot write the arcs of " + graphFile.string());
+    }
+    saveGraph(k, nodes, arcs, edges, arrays, graphFile);
+    return MappedGraph(graphFile);
+}
+
+}  // namespace genome
@@ -0,0 +1,30 @@
+#include "ga/Sketch.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace genome {
+
+CountMinSketch::CountMinSketch(const std::size_t width, const std::size_t depth)
+    : rows(std::max<std::size_t>(depth, 1)),
+      mask(std::bit_ceil(std::max<std::size_t>(width, 1)) - 1),
+      counters(rows * (mask + 1), 0) {}
+
+void CountMinSketch::add(const Kmer kmer) {
+    for (std::size_t row = 0; row < rows; row++) {
+        std::uint16_t& counter = counters[row * (mask + 1) + (hashKmer(kmer, row + 1) & mask)];
+        if (counter < std::numeric_limits<std::uint16_t>::max())
+            counter++;
+    }
+}
+
+std::size_t CountMinSketch::count(const Kmer kmer) const {
+    std::size_t result = std::numeric_limits<std::uint16_t>::max();
+    for (std::size_t row = 0; row < rows; row++) {
+        result = std::min<std::size_t>(result, counters[row * (mask + 1) + (hashKmer(kmer, row + 1) & mask)]);
+    }
+    return result;
+}
+
+}  // namespace genome
@@ -0,0 +1,158 @@
+#include "ga/Sorted.hpp"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <stdexcept>
+
+#include "ga/Parallel.hpp"
+
+namespace genome {
+
+namespace {
+
+constexpr std::size_t digitBits = 8;
+constexpr std::size_t radix     = std::size_t{1} << digitBits;
+// blocks smaller than this are not worth a thread
+constexpr std::size_t minBlockSize = 1 << 16;
+
+}  // namespace
+
+void radixSort(std::vector<Kmer>& values, const std::size_t bits, const std::size_t threads) {
+    const std::size_t n         = values.size();
+    const std::size_t blocks    = std::clamp<std::size_t>(n / minBlockSize, 1, std::max<std::size_t>(threads, 1));
+    const std::size_t blockSize = (n + blocks - 1) / blocks;
+    std::vector<std::array<std::size_t, radix>> counts(blocks);
+    std::vector<Kmer> buffer(n);
+    for (std::size_t shift = 0; shift < bits; shift += digitBits) {
+        parallelFor(blocks, threads, [&](std::size_t block) {
+            counts[block].fill(0);
+            for (std::size_t i = block * blockSize; i < std::min(n, (block + 1) * blockSize); i++) {
+                counts[block][(values[i] >> shift) & (radix - 1)]++;
+            }
+        });
+        // turn the counts into the first slot of every (digit, block) pair, blocks in order within a digit
+        std::size_t offset = 0;
+        bool trivial       = false;
+        for (std::size_t digit = 0; digit < radix; digit++) {
+            std::size_t start = offset;
+            for (std::size_t block = 0; block < blocks; block++) {
+                std::size_t count   = counts[block][digit];
+                counts[block][digit] = offset;
+                offset += count;
+            }
+            trivial = trivial || offset - start == n;
+        }
+        if (trivial)
+            continue;
+        parallelFor(blocks, threads, [&](std::size_t block) {
+            std::array<std::size_t, radix>& next = counts[block];
+            for (std::size_t i = block * blockSize; i < std::min(n, (block + 1) * blockSize); i++) {
+                buffer[next[(values[i] >> shift) & (radix - 1)]++] = values[i];
+            }
+        });
+        values.swap(buffer);
+    }
+}
+
+SortedGraph::SortedGraph(const std::size_t k, const std::vector<std::string>& reads, const std::size_t threads)
+    : kmerSize(k) {
+    if (k == 0 || k > maxPackedK)
+        throw std::invalid_argument("sorted graph needs 0 < k <= " + std::to_string(maxPackedK));
+    std::vector<Kmer> all;
+    std::size_t capacity = 0;
+    for (const auto& read : reads) {
+        capacity += read.size() > k ? read.size() - k : 0;
+    }
+    all.reserve(capacity);
+    for (const auto& read : reads) {
+        forEachKmer(read, k + 1, [&](Kmer edge) { all.push_back(edge); });
+    }
+    radixSort(all, 2 * (k + 1), threads);
+
+    // run-length counting, all is reused for the distinct edges
+    std::size_t distinct = 0;
+    for (std::size_t i = 0; i < all.size();) {
+        std::size_t j = i;
+        while (j < all.size() && all[j] == all[i]) {
+            j++;
+        }
+        all[distinct++] = all[i];
+        multiplicities.push_back(j - i);
+        edges += j - i;
+        i = j;
+    }
+    all.resize(distinct);
+    all.shrink_to_fit();
+
+    // prefixes come sorted with the edges, suffixes need a sort of their own
+    std::vector<Kmer> suffixes(distinct);
+    for (std::size_t i = 0; i < distinct; i++) {
+        suffixes[i] = all[i] & kmerMask(k);
+    }
+    radixSort(suffixes, 2 * k, threads);
+    kmers.reserve(distinct);
+    std::size_t s = 0;
+    for (std::size_t i = 0; i < distinct || s < distinct;) {
+        Kmer next;
+        if (s == distinct || (i < distinct && (all[i] >> 2) <= suffixes[s]))
+            next = all[i++] >> 2;
+        else
+            next = suffixes[s++];
+        if (kmers.empty() || kmers.back() != next)
+            kmers.push_back(next);
+    }
+    suffixes = {};
+
+    offsets.reserve(kmers.size() + 1);
+    bases.resize(distinct);
+    targets.resize(distinct);
+    in.assign(kmers.size(), 0);
+    for (std::size_t node = 0, e = 0; node < kmers.size(); node++) {
+        offsets.push_back(e);
+        while (e < distinct && (all[e] >> 2) == kmers[node]) {
+            e++;
+        }
+    }
+    offsets.push_back(distinct);
+    constexpr std::size_t blockSize = 1 << 14;
+    parallelFor((distinct + blockSize - 1) / blockSize, threads, [&](std::size_t block) {
+        for (std::size_t e = block * blockSize; e < std::min(distinct, (block + 1) * blockSize); e++) {
+            bases[e]   = lastBase(all[e]);
+            targets[e] = find(all[e] & kmerMask(k));
+        }
+    });
+    for (std::size_t e = 0; e < distinct; e++) {
+        in[targets[e]] += multiplicities[e];
+    }
+}
+
+std::size_t SortedGraph::find(const Kmer kmer) const {
+    auto it = std::lower_bound(kmers.begin(), kmers.end(), kmer);
+    return it != kmers.end() && *it == kmer ? static_cast<std::size_t>(it - kmers.begin()) : npos;
+}
+
+std::size_t SortedGraph::arc(const std::size_t node, const std::uint8_t base) const {
+    std::size_t i = offsets[node];
+    while (i < offsets[node + 1] && bases[i] != base) {
+        i++;
+    }
+    return i;
+}
+
+std::size_t SortedGraph::multiplicity(const std::size_t node, const std::uint8_t base) const {
+    std::size_t i = arc(node, base);
+    return i < offsets[node + 1] ? multiplicities[i] : 0;
+}
+
+std::size_t SortedGraph::successor(const std::size_t node, const std::uint8_t base) const {
+    std::size_t i = arc(node, base);
+    return i < offsets[node + 1] ? targets[i] : npos;
+}
+
+std::size_t SortedGraph::outDegree(const std::size_t node) const {
+    return std::accumulate(multiplicities.begin() + static_cast<std::ptrdiff_t>(offsets[node]),
+                           multiplicities.begin() + static_cast<std::ptrdiff_t>(offsets[node + 1]), std::size_t{0});
+}
+
+}  // namespace genome
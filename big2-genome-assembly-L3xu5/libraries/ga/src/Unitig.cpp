@@ -0,0 +1,205 @@
+#include "ga/Unitig.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace genome {
+
+namespace {
+
+template <class Graph>
+bool isSimple(const Graph& graph, const std::size_t node) {
+    return graph.inDegree(node) == 1 && graph.outDegree(node) == 1;
+}
+
+// a k-mer equal to its reverse complement is where the two strands touch, a chain walked
+// through it would go on along the other strand, so it is always a junction
+bool isSimple(const CanonicalGraph& graph, const std::size_t node) {
+    const Kmer kmer = graph.kmer(node);
+    return kmer != reverseComplement(kmer, graph.k()) && graph.inDegree(node) == 1 && graph.outDegree(node) == 1;
+}
+
+template <class Graph>
+std::uint8_t singleBase(const Graph& graph, const std::size_t node) {
+    std::uint8_t base = 0;
+    while (graph.multiplicity(node, base) == 0) {
+        base++;
+    }
+    return base;
+}
+
+}  // namespace
+
+UnitigGraph::UnitigGraph(const DeBruijnGraph& graph) : kmerSize(graph.k()) { compact(graph); }
+
+UnitigGraph::UnitigGraph(const MappedGraph& graph) : kmerSize(graph.k()) { compact(graph); }
+
+UnitigGraph::UnitigGraph(const SortedGraph& graph) : kmerSize(graph.k()) { compact(graph); }
+
+UnitigGraph::UnitigGraph(const CanonicalGraph& graph) : kmerSize(graph.k()) {
+    std::vector<std::size_t> junction = compact(graph);
+    twins.resize(edges.size());
+    for (std::size_t i = 0; i < edges.size(); i++) {
+        const Unitig& unitig = edges[i];
+        // the twin leaves the reverse complement of the end node by the complement
+        // of the base standing k positions before the end of the unitig
+        std::size_t from  = junction[graph.find(reverseComplement(kmers[unitig.to], kmerSize))];
+        std::size_t back  = unitig.length - 1;
+        std::uint8_t base = complementBase(back < kmerSize ? firstBase(kmers[unitig.from] << (2 * back), kmerSize)
+                                                           : sequence[unitig.offset + back - kmerSize]);
+        for (std::size_t j = outOffsets[from]; j < outOffsets[from + 1]; j++) {
+            if (sequence[edges[j].offset] == base)
+                twins[i] = j;
+        }
+    }
+}
+
+template <class Graph>
+std::vector<std::size_t> UnitigGraph::compact(const Graph& graph) {
+    const std::size_t n = graph.nodeCount();
+    std::vector<std::size_t> junction(n, DeBruijnGraph::npos);
+    std::vector<std::size_t> origin;
+    std::vector<bool> visited(n, false);
+
+    auto addJunction = [&](std::size_t node) {
+        junction[node] = origin.size();
+        origin.push_back(node);
+        kmers.push_back(graph.kmer(node));
+        in.push_back(graph.inDegree(node));
+        out.push_back(graph.outDegree(node));
+    };
+    auto walk = [&](std::size_t j, std::uint8_t base, std::size_t multiplicity) {
+        std::size_t offset = sequence.size();
+        std::size_t node   = origin[j];
+        sequence.push_back(base);
+        std::size_t cur = graph.successor(node, base);
+        while (isSimple(graph, cur) && !visited[cur]) {
+            visited[cur] = true;
+            base         = singleBase(graph, cur);
+            sequence.push_back(base);
+            cur = graph.successor(cur, base);
+        }
+        edges.push_back(Unitig{j, junction[cur], offset, sequence.size() - offset, multiplicity});
+    };
+
+    auto addUnitigsFrom = [&](std::size_t j) {
+        std::size_t node = origin[j];
+        outOffsets.push_back(edges.size());
+        for (std::uint8_t base = 0; base < 4; base++) {
+            std::size_t multiplicity = graph.multiplicity(node, base);
+            if (multiplicity == 0)
+                continue;
+            walk(j, base, multiplicity);
+        }
+    };
+
+    for (std::size_t node = 0; node < n; node++) {
+        // cleaning can leave nodes without edges, they are no part of any unitig
+        if (graph.inDegree(node) == 0 && graph.outDegree(node) == 0)
+            visited[node] = true;
+        else if (!isSimple(graph, node))
+            addJunction(node);
+    }
+    // every simple node reachable from a junction is visited here,
+    // so the leftovers form cycles without junctions
+    std::size_t junctions = origin.size();
+    for (std::size_t j = 0; j < junctions; j++) {
+        addUnitigsFrom(j);
+    }
+    for (std::size_t node = 0; node < n; node++) {
+        if (!visited[node] && junction[node] == DeBruijnGraph::npos) {
+            std::size_t first = origin.size();
+            visited[node]     = true;
+            addJunction(node);
+            // on both strands the cycle is anchored at the reverse complements of each other, so twin unitigs
+            // end at twin junctions; a cycle which is its own reverse complement gets split into two twins
+            if constexpr (std::is_same_v<Graph, CanonicalGraph>) {
+                std::size_t twin = graph.find(reverseComplement(graph.kmer(node), kmerSize));
+                if (junction[twin] == DeBruijnGraph::npos) {
+                    visited[twin] = true;
+                    addJunction(twin);
+                }
+            }
+            for (std::size_t j = first; j < origin.size(); j++) {
+                addUnitigsFrom(j);
+            }
+        }
+    }
+    outOffsets.push_back(edges.size());
+    return junction;
+}
+
+UnitigGraph::UnitigGraph(const BloomGraph& graph) : kmerSize(graph.k()), kmers(graph.junctions()) {
+    auto junction = [&](Kmer kmer) {
+        auto it = std::lower_bound(kmers.begin(), kmers.end(), kmer);
+        return it != kmers.end() && *it == kmer ? static_cast<std::size_t>(it - kmers.begin()) : DeBruijnGraph::npos;
+    };
+    for (Kmer kmer : kmers) {
+        in.push_back(graph.inDegree(kmer));
+        out.push_back(graph.outDegree(kmer));
+    }
+    for (std::size_t j = 0; j < kmers.size(); j++) {
+        outOffsets.push_back(edges.size());
+        for (std::uint8_t base = 0; base < 4; base++) {
+            if (!graph.hasEdge(kmers[j], base))
+                continue;
+            std::size_t offset = sequence.size();
+            sequence.push_back(base);
+            Kmer cur       = appendBase(kmers[j], base, kmerSize);
+            std::size_t to = junction(cur);
+            // a node which is not a junction has exactly one edge out
+            while (to == DeBruijnGraph::npos) {
+                std::uint8_t next = 0;
+                while (!graph.hasEdge(cur, next)) {
+                    next++;
+                }
+                sequence.push_back(next);
+                cur = appendBase(cur, next, kmerSize);
+                to  = junction(cur);
+            }
+            edges.push_back(Unitig{j, to, offset, sequence.size() - offset, 1});
+        }
+    }
+    outOffsets.push_back(edges.size());
+}
+
+std::vector<std::size_t> findWay(const UnitigGraph& graph, const std::size_t start) {
+    const std::vector<Unitig>& unitigs = graph.unitigs();
+    std::vector<std::size_t> remaining(unitigs.size());
+    for (std::size_t i = 0; i < unitigs.size(); i++) {
+        remaining[i] = unitigs[i].multiplicity;
+    }
+    std::vector<std::size_t> next(graph.nodeCount());
+    for (std::size_t node = 0; node < graph.nodeCount(); node++) {
+        next[node] = graph.firstOut(node);
+    }
+
+    std::vector<std::size_t> way;
+    std::vector<std::size_t> nodes = {start};
+    std::vector<std::size_t> steps;
+    while (!nodes.empty()) {
+        std::size_t cur = nodes.back();
+        std::size_t end = graph.firstOut(cur + 1);
+        while (next[cur] < end && remaining[next[cur]] == 0) {
+            next[cur]++;
+        }
+        if (next[cur] < end) {
+            std::size_t step = next[cur];
+            remaining[step]--;
+            if (graph.doubleStranded() && graph.twin(step) != step)
+                remaining[graph.twin(step)]--;
+            nodes.push_back(unitigs[step].to);
+            steps.push_back(step);
+        } else {
+            nodes.pop_back();
+            if (!steps.empty()) {
+                way.push_back(steps.back());
+                steps.pop_back();
+            }
+        }
+    }
+    std::reverse(way.begin(), way.end());
+    return way;
+}
+
+}  // namespace genome
@@ -1,8 +1,26 @@
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
 #include <string>
 
+#include "ga/Assembler.hpp"
+#include "ga/Bloom.hpp"
+#include "ga/Cleaning.hpp"
+#include "ga/Components.hpp"
 #include "ga/Genome.hpp"
+#include "ga/Graph.hpp"
+#include "ga/GraphFile.hpp"
+#include "ga/Kmer.hpp"
+#include "ga/MultiK.hpp"
+#include "ga/Partition.hpp"
+#include "ga/Sorted.hpp"
+#include "ga/Unitig.hpp"
 #include "gtest/gtest.h"
 
 namespace genome {
@@ -67,6 +85,7 @@ TEST(GenomeTest, it_works_when_fragments_are_big) {
 TEST(GenomeTest, it_works_when_k_1_d_3) {
     EXPECT_EQ("AATCC", assembly(1, {"AAT", "TCC"}));
     EXPECT_EQ("AATGTCC", assembly(1, {"AAT", "TCC", "TGT"}));
+    EXPECT_EQ("AATGTCC", assembly(1, {"AAT", "TCC", "TGT"}, GraphBackend::Exact));
     EXPECT_EQ("CCAAGTG", assembly(1, {"GTG", "CCA", "AAG"}));
 }
 
@@ -109,6 +128,23 @@ std::vector<std::string> reads_from_file(const char *name) {
     file.close();
     return reads;
 }
+
+// uniquely named directory for the files of one test, removed with them at its end
+struct TempDirectory {
+    std::filesystem::path path;
+
+    TempDirectory() {
+        std::string pattern = (std::filesystem::temp_directory_path() / "ga-test-XXXXXX").string();
+        if (mkdtemp(pattern.data()) == nullptr)
+            throw std::runtime_error("cannot create " + pattern);
+        path = pattern;
+    }
+
+    ~TempDirectory() {
+        std::error_code ignored;
+        std::filesystem::remove_all(path, ignored);
+    }
+};
 }  // namespace
 
 TEST(GenomeTest, it_works_when_input_is_big) {
@@ -120,6 +156,523 @@ TEST(GenomeTest, it_works_when_input_is_bigger) {
               assembly(25, reads_from_file("test/etc/bigger_reads.txt")));
 }
 
+TEST(BloomTest, it_works_when_genome_has_no_repeats) {
+    EXPECT_EQ("TAGAACT", assembly(3, {"TAGAA", "GAACT"}, GraphBackend::Bloom));
+    EXPECT_EQ("CGTCTATGCAGGGTAACCCCTTAGGATACGAATGGCTGTCCACGTGGACAACGCGCCCTGGAGTGGTTGCCTACTTGAACTATAT",
+              assembly(5,
+                       {
+                           "CACGTGGACAACGCGCCCTGGAGTG",
+                           "CGTCTATGCAGGGTAACCCCTTAGG",
+                           "GAGTGGTTGCCTACTTGAACTATAT",
+                           "TTAGGATACGAATGGCTGTCCACGT",
+                       },
+                       GraphBackend::Bloom));
+}
+
+TEST(BloomTest, it_works_when_input_is_bigger) {
+    const std::vector<std::string> reads = reads_from_file("test/etc/bigger_reads.txt");
+    BloomGraph graph(25, reads);
+    EXPECT_LT(graph.bytes(), graph.edgeCount() * 4);
+    EXPECT_EQ(genome_from_file("test/etc/bigger_genome.txt"), assembly(UnitigGraph(graph)));
+}
+
+TEST(CanonicalTest, it_reverses_complement) {
+    EXPECT_EQ(packKmer("AGGTC"), reverseComplement(packKmer("GACCT"), 5));
+    EXPECT_EQ(packKmer("ACGT"), reverseComplement(packKmer("ACGT"), 4));
+    EXPECT_EQ(packKmer(std::string(31, 'A')), reverseComplement(packKmer(std::string(31, 'T')), 31));
+    CanonicalKmer key = canonical(packKmer("TTG"), 3);
+    EXPECT_EQ(packKmer("CAA"), key.kmer);
+    EXPECT_TRUE(key.reversed);
+}
+
+namespace {
+std::string reverse_complement(const std::string &bases) {
+    return unpackKmer(reverseComplement(packKmer(bases), bases.size()), bases.size());
+}
+}  // namespace
+
+TEST(CanonicalTest, it_works_when_reads_come_from_both_strands) {
+    std::string genome;
+    std::uint32_t seed = 777;
+    for (int i = 0; i < 405; i++) {
+        seed = seed * 1103515245 + 12345;
+        genome += "ACGT"[(seed >> 16) & 3];
+    }
+    std::vector<std::string> reads;
+    for (std::size_t i = 0; i + 30 <= genome.size(); i += 15) {
+        std::string read = genome.substr(i, 30);
+        reads.push_back(reads.size() % 2 ? reverse_complement(read) : read);
+    }
+    std::string result = assembly(15, reads, GraphBackend::Canonical);
+    EXPECT_TRUE(result == genome || result == reverse_complement(genome)) << result;
+
+    CanonicalGraph graph(15);
+    DeBruijnGraph doubled(15);
+    for (const auto &read : reads) {
+        graph.addRead(read);
+        doubled.addRead(read);
+        doubled.addRead(reverse_complement(read));
+    }
+    EXPECT_EQ(doubled.nodeCount(), 2 * graph.kmerCount());
+}
+
+TEST(CanonicalTest, it_stops_at_palindromic_kmers) {
+    // ACGT is its own reverse complement, walking through it would append the other strand
+    std::string result = assembly(4, {"ACGTTTCAG"}, GraphBackend::Canonical);
+    EXPECT_TRUE(result == "ACGTTTCAG" || result == reverse_complement("ACGTTTCAG")) << result;
+    result = assembly(4, {"CTGAAACGT"}, GraphBackend::Canonical);
+    EXPECT_TRUE(result == "CTGAAACGT" || result == reverse_complement("CTGAAACGT")) << result;
+    // both ends palindromic, no node has more edges leaving than entering
+    result = assembly(4, {"CATGATC"}, GraphBackend::Canonical);
+    EXPECT_TRUE(result == "CATGATC" || result == reverse_complement("CATGATC")) << result;
+}
+
+TEST(DiskTest, it_matches_in_memory_graph) {
+    TempDirectory scratch;
+    std::istringstream reads("AATCT\nACGAA\nGCTAC\n");
+    DiskOptions options;
+    options.directory     = scratch.path;
+    options.buckets       = 3;
+    options.minimizerSize = 2;
+    EXPECT_EQ("GCTACGAATCT", assembly(UnitigGraph(buildOnDisk(2, reads, scratch.path / "graph.bin", options))));
+}
+
+TEST(DiskTest, it_splits_reads_at_ambiguous_bases) {
+    TempDirectory scratch;
+    const std::string text = "AATCTNNACGAATT\nNGCTACGN\nACGNT\n";
+    std::istringstream reads(text);
+    DiskOptions options;
+    options.directory     = scratch.path;
+    options.buckets       = 2;
+    options.minimizerSize = 2;
+    MappedGraph mapped    = buildOnDisk(3, reads, scratch.path / "graph.bin", options);
+    DeBruijnGraph graph(3);
+    std::istringstream lines(text);
+    for (std::string read; std::getline(lines, read);) {
+        graph.addRead(read);
+    }
+    EXPECT_EQ(graph.nodeCount(), mapped.nodeCount());
+    EXPECT_EQ(graph.edgeCount(), mapped.edgeCount());
+    for (std::size_t node = 0; node < graph.nodeCount(); node++) {
+        const std::size_t other = mapped.find(graph.kmer(node));
+        ASSERT_NE(MappedGraph::npos, other);
+        EXPECT_EQ(graph.inDegree(node), mapped.inDegree(other));
+        EXPECT_EQ(graph.outDegree(node), mapped.outDegree(other));
+    }
+}
+
+TEST(DiskTest, it_works_when_input_is_bigger) {
+    TempDirectory scratch;
+    const std::filesystem::path path = scratch.path / "graph.bin";
+    std::ifstream reads("test/etc/bigger_reads.txt");
+    DiskOptions options;
+    options.directory = scratch.path;
+    // far below the buckets' estimated size, so that they are split before being built
+    options.memoryBudget = std::size_t{1} << 20;
+    options.buckets      = 16;
+    options.threads      = 4;
+    MappedGraph graph    = buildOnDisk(25, reads, path, options);
+    EXPECT_EQ(genome_from_file("test/etc/bigger_genome.txt"), assembly(UnitigGraph(graph)));
+    // the scratch files are gone, only the graph file is left
+    std::filesystem::directory_iterator entries(scratch.path);
+    EXPECT_EQ(1, std::distance(entries, std::filesystem::directory_iterator{}));
+    EXPECT_TRUE(std::filesystem::exists(path));
+}
+
+TEST(DiskTest, it_fails_without_scratch_directory) {
+    TempDirectory scratch;
+    std::istringstream reads("AATCT\n");
+    DiskOptions options;
+    options.directory = scratch.path / "missing";
+    EXPECT_THROW(buildOnDisk(2, reads, scratch.path / "graph.bin", options), std::runtime_error);
+}
+
+TEST(CleaningTest, it_drops_rare_kmers) {
+    const std::vector<std::string> reads = {"ACGTTGCA", "ACGTTGCA", "ACGTAGCA"};
+    CleaningOptions options;
+    DeBruijnGraph graph = buildFiltered(3, reads, options);
+    // ACGT is in all three reads and the rest of the first read twice, the other 4-mers only once;
+    // edges keep their counts and the nodes are the 3-mers of the kept edges
+    std::map<std::string, std::size_t> counts;
+    for (const auto &read : reads) {
+        for (std::size_t i = 0; i + 4 <= read.size(); i++) {
+            counts[read.substr(i, 4)]++;
+        }
+    }
+    std::size_t edges = 0;
+    std::set<std::string> nodes;
+    for (const auto &[edge, count] : counts) {
+        if (count >= options.minAbundance) {
+            edges += count;
+            nodes.insert(edge.substr(0, 3));
+            nodes.insert(edge.substr(1));
+        }
+    }
+    EXPECT_EQ(edges, graph.edgeCount());
+    EXPECT_EQ(nodes.size(), graph.nodeCount());
+    EXPECT_EQ(DeBruijnGraph::npos, graph.find(packKmer("GTA")));
+}
+
+TEST(CleaningTest, it_removes_tips) {
+    DeBruijnGraph graph(3);
+    for (int i = 0; i < 5; i++) {
+        graph.addRead("AACGTTGCA");
+    }
+    graph.addRead("AACGTTGCC");
+    EXPECT_EQ(1, removeTips(graph, 6));
+    EXPECT_EQ(35, graph.edgeCount());
+    // GCC is left without edges and is not a junction
+    normalizeCoverage(graph);
+    UnitigGraph unitigs(graph);
+    EXPECT_EQ(2, unitigs.nodeCount());
+    EXPECT_EQ(1, unitigs.unitigs().size());
+}
+
+TEST(CleaningTest, it_pops_bubbles) {
+    DeBruijnGraph graph(3);
+    for (int i = 0; i < 5; i++) {
+        graph.addRead("AACGTTGCAT");
+    }
+    graph.addRead("AACGATGCAT");
+    EXPECT_EQ(4, popBubbles(graph, 4));
+    normalizeCoverage(graph);
+    UnitigGraph unitigs(graph);
+    EXPECT_EQ(2, unitigs.nodeCount());
+    EXPECT_EQ(1, unitigs.unitigs().size());
+    EXPECT_EQ("AACGTTGCAT", assembly(graph));
+}
+
+TEST(CleaningTest, it_works_when_reads_have_errors) {
+    std::string genome;
+    std::uint32_t seed = 12345;
+    for (int i = 0; i < 300; i++) {
+        seed = seed * 1103515245 + 12345;
+        genome += "ACGT"[(seed >> 16) & 3];
+    }
+    std::vector<std::string> reads;
+    for (std::size_t i = 0; i + 30 <= genome.size(); i += 3) {
+        reads.push_back(genome.substr(i, 30));
+        reads.push_back(genome.substr(i, 30));
+    }
+    reads[7][12]  = reads[7][12] == 'A' ? 'C' : 'A';
+    reads[40][29] = reads[40][29] == 'G' ? 'T' : 'G';
+    reads[81][3]  = 'N';
+    EXPECT_EQ(genome, assembly(15, reads, CleaningOptions{}));
+}
+
+TEST(CleaningTest, it_recovers_genome_from_simulated_reads) {
+    // 30x coverage of 100-base reads with 1% substitutions, a typical short-read error rate
+    const std::size_t genomeSize = 20000;
+    const std::size_t readLength = 100;
+    const std::size_t coverage   = 30;
+    const double errorRate       = 0.01;
+    std::mt19937_64 random(2024);
+    std::string genome;
+    for (std::size_t i = 0; i < genomeSize; i++) {
+        genome += "ACGT"[random() % 4];
+    }
+    std::uniform_int_distribution<std::size_t> start(0, genomeSize - readLength);
+    std::bernoulli_distribution error(errorRate);
+    std::vector<std::string> reads;
+    std::size_t errors = 0;
+    auto addRead       = [&](std::size_t from) {
+        std::string read = genome.substr(from, readLength);
+        for (char &base : read) {
+            if (error(random)) {
+                base = "ACGT"[(encodeBase(base) + 1 + random() % 3) % 4];
+                errors++;
+            }
+        }
+        reads.push_back(read);
+    };
+    for (std::size_t i = 0; i < coverage * genomeSize / readLength; i++) {
+        addRead(start(random));
+    }
+    // the ends of the genome get the coverage of the middle as well
+    for (std::size_t i = 0; i < coverage / 2; i++) {
+        addRead(0);
+        addRead(genomeSize - readLength);
+    }
+    EXPECT_LT(5000, errors);
+    EXPECT_EQ(genome, assembly(25, reads, CleaningOptions{}));
+}
+
+TEST(UnitigTest, it_collapses_single_read) {
+    DeBruijnGraph graph(3);
+    graph.addRead("AACGTTGCA");
+    UnitigGraph unitigs(graph);
+    EXPECT_EQ(7, graph.nodeCount());
+    EXPECT_EQ(2, unitigs.nodeCount());
+    ASSERT_EQ(1, unitigs.unitigs().size());
+    EXPECT_EQ(6, unitigs.unitigs()[0].length);
+    EXPECT_EQ(6, unitigs.bases().size());
+}
+
+TEST(UnitigTest, it_keeps_repeats_as_junctions) {
+    DeBruijnGraph graph(2);
+    for (auto read : {"AATCT", "ACGAA", "GCTAC"}) {
+        graph.addRead(read);
+    }
+    UnitigGraph unitigs(graph);
+    std::size_t edges = 0;
+    for (const Unitig& unitig : unitigs.unitigs()) {
+        edges += unitig.length * unitig.multiplicity;
+    }
+    EXPECT_EQ(graph.edgeCount(), edges);
+    EXPECT_LT(unitigs.nodeCount(), graph.nodeCount());
+}
+
+TEST(UnitigTest, it_anchors_isolated_cycles) {
+    DeBruijnGraph graph(2);
+    graph.addRead("ACGTAC");
+    UnitigGraph unitigs(graph);
+    EXPECT_EQ(1, unitigs.nodeCount());
+    ASSERT_EQ(1, unitigs.unitigs().size());
+    EXPECT_EQ(4, unitigs.unitigs()[0].length);
+    EXPECT_EQ(4, findWay(unitigs, 0).size() * unitigs.unitigs()[0].length);
+}
+
+TEST(UnitigTest, it_pairs_twins_of_isolated_cycles) {
+    // the circular AACGTT is its own reverse complement, the first two reads hold every one of its edges
+    // on one of the strands; the circular CCCAG is not its own reverse complement
+    CanonicalGraph graph(3);
+    graph.addRead("AACGT");
+    graph.addRead("GTTAA");
+    graph.addRead("CCCAGCCC");
+    UnitigGraph unitigs(graph);
+    ASSERT_TRUE(unitigs.doubleStranded());
+    std::size_t edges = 0;
+    for (std::size_t i = 0; i < unitigs.unitigs().size(); i++) {
+        const Unitig &unitig = unitigs.unitigs()[i];
+        const Unitig &twin   = unitigs.unitigs()[unitigs.twin(i)];
+        EXPECT_EQ(i, unitigs.twin(unitigs.twin(i)));
+        EXPECT_EQ(unitig.length, twin.length);
+        EXPECT_EQ(reverseComplement(unitigs.kmer(unitig.to), 3), unitigs.kmer(twin.from));
+        edges += unitig.length;
+    }
+    // the first cycle is its own twin, the second one has one on the other strand
+    EXPECT_EQ(6 + 2 * 5, edges);
+}
+
+TEST(UnitigTest, it_writes_to_stream_and_buffer) {
+    DeBruijnGraph graph(25);
+    for (const auto &read : reads_from_file("test/etc/bigger_reads.txt")) {
+        graph.addRead(read);
+    }
+    UnitigGraph unitigs(graph);
+    const std::string genome = genome_from_file("test/etc/bigger_genome.txt");
+    std::ostringstream out;
+    EXPECT_EQ(genome.size(), assembly(unitigs, out));
+    EXPECT_EQ(genome, out.str());
+
+    std::vector<char> buffer(genome.size() - 1, 'x');
+    EXPECT_EQ(genome.size(), assembly(unitigs, buffer));
+    EXPECT_EQ(std::string(buffer.size(), 'x'), std::string(buffer.begin(), buffer.end()));
+    buffer.resize(genome.size());
+    EXPECT_EQ(genome.size(), assembly(unitigs, buffer));
+    EXPECT_EQ(genome, std::string(buffer.begin(), buffer.end()));
+}
+
+TEST(UnitigTest, it_splits_into_contigs) {
+    std::vector<std::string> parts = contigs(3, {"AACGTTGCA", "CCCTAGGNGATCC"});
+    std::sort(parts.begin(), parts.end());
+    EXPECT_EQ((std::vector<std::string>{"AACGTTGCA", "CCCTAGG", "GATCC"}), parts);
+
+    for (const auto &contig : contigs(2, {"AATCT", "ACGAA", "GCTAC"})) {
+        EXPECT_NE(std::string::npos, std::string("GCTACGAATCT").find(contig)) << contig;
+    }
+    EXPECT_TRUE(contigs(UnitigGraph(DeBruijnGraph(2))).empty());
+    EXPECT_TRUE(contigs(0, {"AATCT", "ACGAA"}).empty());
+    EXPECT_EQ("", assembly(0, {"AATCT", "ACGAA"}, GraphBackend::Canonical));
+}
+
+TEST(AssemblerTest, it_matches_batch_assembly) {
+    const std::vector<std::string> reads = reads_from_file("test/etc/big_reads.txt");
+    Assembler assembler(10);
+    const std::size_t half = reads.size() / 2;
+    assembler.addReads(std::vector<std::string>(reads.begin(), reads.begin() + half));
+    assembler.addReads(std::vector<std::string>(reads.begin() + half, reads.end()));
+    EXPECT_EQ(genome_from_file("test/etc/big_genome.txt"), assembler.assembly());
+    EXPECT_EQ(1, assembler.componentCount());
+}
+
+TEST(AssemblerTest, it_recomputes_only_touched_components) {
+    Assembler assembler(3);
+    assembler.addReads({"AACGTTGCA", "CCCTAGG"});
+    EXPECT_EQ(2, assembler.componentCount());
+    EXPECT_EQ((std::vector<std::string>{"AACGTTGCA", "CCCTAGG"}), assembler.contigs());
+    EXPECT_EQ(2, assembler.recomputed());
+
+    assembler.addRead("AGGATC");
+    EXPECT_EQ((std::vector<std::string>{"AACGTTGCA", "CCCTAGGATC"}), assembler.contigs());
+    EXPECT_EQ(3, assembler.recomputed());
+    EXPECT_EQ("CCCTAGGATC", assembler.assembly());
+    EXPECT_EQ("CCCTAGGATC", assembler.assembly());
+    EXPECT_EQ(4, assembler.recomputed());
+}
+
+TEST(MultiKTest, it_packs_reads_split_at_other_letters) {
+    PackedReads packed;
+    packed.add("ACGTNNAC");
+    packed.add("N");
+    packed.add("GGA");
+    EXPECT_EQ(3, packed.size());
+    EXPECT_EQ(9, packed.bases());
+    std::vector<std::string> kmers;
+    packed.forEachKmer(3, [&](Kmer kmer) { kmers.push_back(unpackKmer(kmer, 3)); });
+    EXPECT_EQ((std::vector<std::string>{"ACG", "CGT", "GGA"}), kmers);
+}
+
+TEST(MultiKTest, it_bridges_coverage_gaps) {
+    std::string genome;
+    std::uint32_t seed = 2024;
+    for (int i = 0; i < 300; i++) {
+        seed = seed * 1103515245 + 12345;
+        genome += "ACGT"[(seed >> 16) & 3];
+    }
+    // neighbouring reads overlap by 12 bases, too few for the 21-mer edges of k = 20
+    std::vector<std::string> reads;
+    for (std::size_t i = 0; i + 24 <= genome.size(); i += 12) {
+        reads.push_back(genome.substr(i, 24));
+    }
+    EXPECT_GT(contigs(20, reads).size(), 1);
+    EXPECT_EQ((std::vector<std::string>{genome}), multiKContigs(reads, {9, 20}));
+    EXPECT_THROW(multiKContigs(reads, {20, 9}), std::invalid_argument);
+}
+
+TEST(ComponentsTest, it_finds_components_in_parallel) {
+    DeBruijnGraph graph(3);
+    for (auto read : {"AACGTTGCA", "CCCTAGG", "AGGATCCGG", "TTTTGTT"}) {
+        graph.addRead(read);
+    }
+    const std::vector<std::size_t> roots = components(graph, 4);
+    EXPECT_EQ(roots, components(graph, 1));
+    EXPECT_EQ(0, roots[graph.find(packKmer("GCA"))]);
+    EXPECT_EQ(roots[graph.find(packKmer("CCC"))], roots[graph.find(packKmer("CGG"))]);
+    EXPECT_NE(roots[graph.find(packKmer("CCC"))], roots[graph.find(packKmer("TTT"))]);
+
+    std::vector<std::string> parallel = parallelContigs(graph, 4);
+    EXPECT_EQ(parallel, parallelContigs(graph, 1));
+    std::vector<std::string> serial = contigs(UnitigGraph(graph));
+    std::sort(parallel.begin(), parallel.end());
+    std::sort(serial.begin(), serial.end());
+    EXPECT_EQ(serial, parallel);
+}
+
+TEST(GraphFileTest, it_maps_saved_graph) {
+    DeBruijnGraph graph(10);
+    for (const auto &read : reads_from_file("test/etc/big_reads.txt")) {
+        graph.addRead(read);
+    }
+    TempDirectory scratch;
+    const std::filesystem::path path = scratch.path / "graph.bin";
+    saveGraph(graph, path);
+    {
+        MappedGraph mapped(path);
+        EXPECT_EQ(graph.nodeCount(), mapped.nodeCount());
+        EXPECT_EQ(graph.edgeCount(), mapped.edgeCount());
+        EXPECT_EQ(graph.find(graph.kmer(7)), mapped.find(graph.kmer(7)));
+        EXPECT_EQ(genome_from_file("test/etc/big_genome.txt"), assembly(UnitigGraph(mapped)));
+        EXPECT_EQ(assembly(graph), assembly(mapped.toGraph()));
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    EXPECT_THROW(MappedGraph{path}, std::runtime_error);
+    std::filesystem::remove(path);
+    EXPECT_THROW(MappedGraph{path}, std::runtime_error);
+}
+
+TEST(GraphFileTest, it_rejects_damaged_graph) {
+    DeBruijnGraph graph(3);
+    graph.addRead("AACGTTGCA");
+    TempDirectory scratch;
+    const std::filesystem::path path = scratch.path / "graph.bin";
+    // header of 48 bytes, then kmers, in and offsets of the 7 nodes, then the targets
+    auto damage = [&](std::streamoff position, auto value) {
+        saveGraph(graph, path);
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(position);
+        file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+    damage(12, std::uint32_t{40});
+    EXPECT_THROW(MappedGraph{path}, std::runtime_error);
+    // 4 * nodes wraps around to the 28 words of the real nodes
+    damage(24, std::uint64_t{7 + (1ULL << 62)});
+    EXPECT_THROW(MappedGraph{path}, std::runtime_error);
+    damage(48 + 8 * (2 * 7 + 1), std::uint64_t{5});
+    EXPECT_THROW(MappedGraph{path}, std::runtime_error);
+    damage(48 + 8 * (3 * 7 + 1), std::uint64_t{7});
+    EXPECT_THROW(MappedGraph{path}, std::runtime_error);
+    saveGraph(graph, path);
+    EXPECT_EQ(7, MappedGraph(path).nodeCount());
+}
+
+TEST(SortedTest, it_radix_sorts_kmers) {
+    std::vector<Kmer> values;
+    std::uint64_t seed = 42;
+    for (int i = 0; i < 300000; i++) {
+        seed = hashKmer(seed, 1);
+        values.push_back(seed & kmerMask(13));
+    }
+    std::vector<Kmer> expected = values;
+    std::sort(expected.begin(), expected.end());
+    radixSort(values, 26, 4);
+    EXPECT_EQ(expected, values);
+}
+
+TEST(SortedTest, it_matches_hashed_graph) {
+    const std::vector<std::string> reads = reads_from_file("test/etc/big_reads.txt");
+    SortedGraph sorted(10, reads, 2);
+    DeBruijnGraph hashed(10);
+    for (const auto &read : reads) {
+        hashed.addRead(read);
+    }
+    EXPECT_EQ(hashed.nodeCount(), sorted.nodeCount());
+    EXPECT_EQ(hashed.edgeCount(), sorted.edgeCount());
+    for (std::size_t i = 1; i < sorted.nodeCount(); i++) {
+        ASSERT_LT(sorted.kmer(i - 1), sorted.kmer(i));
+    }
+    std::size_t node = hashed.find(sorted.kmer(5));
+    for (std::uint8_t base = 0; base < 4; base++) {
+        EXPECT_EQ(hashed.multiplicity(node, base), sorted.multiplicity(5, base));
+    }
+    EXPECT_EQ(hashed.inDegree(node), sorted.inDegree(5));
+    EXPECT_EQ(genome_from_file("test/etc/big_genome.txt"), assembly(10, reads, GraphBackend::Sorted));
+}
+
+TEST(KmerTest, it_encodes_blocks_like_single_bases) {
+    std::string letters;
+    for (int i = 0; i < 300; i++) {
+        letters += i % 7 == 3 ? static_cast<char>(i % 256) : "ACGTACGTN"[(i * 5) % 9];
+    }
+    for (std::size_t start = 0; start < letters.size(); start += 41) {
+        const std::size_t count = std::min<std::size_t>(blockBases, letters.size() - start);
+        std::array<std::uint8_t, blockBases> codes{};
+        std::uint64_t invalid = encodeBlock(letters.data() + start, count, codes.data());
+        for (std::size_t i = 0; i < count; i++) {
+            std::uint8_t code = encodeBase(letters[start + i]);
+            ASSERT_EQ(code == invalidBase, ((invalid >> i) & 1) == 1) << start + i;
+            if (code != invalidBase) {
+                ASSERT_EQ(code, codes[i]) << start + i;
+            }
+        }
+        EXPECT_EQ(0, count == blockBases ? 0 : invalid >> count);
+    }
+}
+
+TEST(KmerTest, it_splits_reads_at_ambiguous_bases) {
+    std::vector<std::string> runs;
+    std::string read = "NACGT" + std::string(70, 'A') + "NNGTn" + std::string(60, 'C') + "N";
+    forEachRun(read, [&](std::string_view run) { runs.emplace_back(run); });
+    EXPECT_EQ((std::vector<std::string>{"ACGT" + std::string(70, 'A'), "GT", std::string(60, 'C')}), runs);
+    EXPECT_FALSE(isPackable(read));
+    EXPECT_TRUE(isPackable(std::string(100, 'G')));
+
+    DeBruijnGraph graph(3);
+    graph.addRead("ACGTNCGTANAC");
+    EXPECT_EQ(3, graph.nodeCount());
+    EXPECT_EQ(2, graph.edgeCount());
+}
+
 }  // namespace genome
 
 int main(int argc, char **argv) {
@@ -0,0 +1,335 @@
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ga/Cleaning.hpp"
+#include "ga/Components.hpp"
+#include "ga/Genome.hpp"
+#include "ga/Graph.hpp"
+#include "ga/Kmer.hpp"
+#include "ga/Partition.hpp"
+#include "ga/Sorted.hpp"
+#include "ga/Unitig.hpp"
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+}  // namespace
+
+// counts every allocation made through the global operator new
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+// the default memory resource allocates through the aligned overload
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void* memory = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+namespace {
+
+struct Options {
+    std::size_t genomeLength = 1000000;
+    std::size_t readLength   = 100;
+    double coverage          = 10;
+    // at 0.5% the cleaning pipeline needs about 20x coverage to recover the genome, below that a few
+    // stretches of it are seen fewer than minAbundance times without an error
+    double errorRate         = 0;
+    // copies of one random segment pasted over the genome
+    std::size_t repeats      = 0;
+    std::size_t repeatLength = 500;
+    std::size_t k            = 25;
+    std::size_t threads      = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t seed       = 1;
+};
+
+void usage() {
+    std::cerr << "usage: benchmark [--genome N] [--read-length N] [--coverage X] [--error-rate X]\n"
+                 "                 [--repeats N] [--repeat-length N] [--k N] [--threads N] [--seed N]\n";
+}
+
+bool parse(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc)
+            return false;
+        std::string name  = argv[i];
+        std::string value = argv[i + 1];
+        if (name == "--genome")
+            options.genomeLength = std::stoul(value);
+        else if (name == "--read-length")
+            options.readLength = std::stoul(value);
+        else if (name == "--coverage")
+            options.coverage = std::stod(value);
+        else if (name == "--error-rate")
+            options.errorRate = std::stod(value);
+        else if (name == "--repeats")
+            options.repeats = std::stoul(value);
+        else if (name == "--repeat-length")
+            options.repeatLength = std::stoul(value);
+        else if (name == "--k")
+            options.k = std::stoul(value);
+        else if (name == "--threads")
+            options.threads = std::max<std::size_t>(1, std::stoul(value));
+        else if (name == "--seed")
+            options.seed = std::stoull(value);
+        else
+            return false;
+    }
+    return options.k > 0 && options.k <= genome::maxPackedK && options.readLength > options.k &&
+           options.genomeLength >= options.readLength && options.repeatLength <= options.genomeLength;
+}
+
+// uniform random genome with the repeat segment pasted at random places
+std::string simulateGenome(const Options& options, std::mt19937_64& random) {
+    std::uniform_int_distribution<int> base(0, 3);
+    std::string genome(options.genomeLength, 'A');
+    for (char& c : genome) {
+        c = genome::decodeBase(base(random));
+    }
+    if (options.repeats > 0 && options.repeatLength > 0) {
+        std::string repeat = genome.substr(0, options.repeatLength);
+        std::uniform_int_distribution<std::size_t> position(0, options.genomeLength - options.repeatLength);
+        for (std::size_t i = 0; i < options.repeats; i++) {
+            genome.replace(position(random), options.repeatLength, repeat);
+        }
+    }
+    return genome;
+}
+
+// reads start every readLength / coverage bases and come in random order; the ones hanging over either end
+// of the genome are cut there, so the ends are covered as deeply as the rest, which the abundance filter of
+// the cleaning pipeline needs, and after normalizeCoverage every edge has its copy number;
+// every base is substituted with probability errorRate
+std::vector<std::string> simulateReads(const std::string& genome, const Options& options, std::mt19937_64& random) {
+    const auto stride = std::max<std::size_t>(
+        1, static_cast<std::size_t>(static_cast<double>(options.readLength) / options.coverage));
+    // starts are shifted by readLength so that the ones before the genome stay positive
+    std::vector<std::size_t> starts;
+    for (std::size_t start = stride; start < genome.size() + options.readLength; start += stride) {
+        starts.push_back(start);
+    }
+    std::shuffle(starts.begin(), starts.end(), random);
+    std::uniform_int_distribution<int> shift(1, 3);
+    std::bernoulli_distribution error(options.errorRate);
+    std::vector<std::string> reads;
+    reads.reserve(starts.size());
+    for (std::size_t start : starts) {
+        const std::size_t first = std::max(start, options.readLength) - options.readLength;
+        std::string read        = genome.substr(first, start - first);
+        if (read.size() <= options.k)
+            continue;
+        if (options.errorRate > 0) {
+            for (char& c : read) {
+                if (error(random))
+                    c = genome::decodeBase((genome::encodeBase(c) + shift(random)) & 3);
+            }
+        }
+        reads.push_back(std::move(read));
+    }
+    return reads;
+}
+
+template <class F>
+double seconds(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::size_t peakBytes() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+}
+
+// resident set right now, 0 where /proc is not available
+std::size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    std::size_t size     = 0;
+    std::size_t resident = 0;
+    statm >> size >> resident;
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+struct StorageCost {
+    std::size_t allocations = 0;
+    double build            = 0;
+    double teardown         = 0;
+};
+
+// builds and destroys a graph of the reads, with the index on the heap or in a monotonic arena
+StorageCost measureStorage(const std::vector<std::string>& reads, const std::size_t k, const bool useArena) {
+    StorageCost cost;
+    std::optional<std::pmr::monotonic_buffer_resource> arena;
+    std::optional<genome::DeBruijnGraph> graph;
+    const std::size_t start = allocations.load();
+    cost.build              = seconds([&] {
+        if (useArena)
+            graph.emplace(k, &arena.emplace());
+        else
+            graph.emplace(k);
+        for (const auto& read : reads) {
+            graph->addRead(read);
+        }
+    });
+    cost.allocations        = allocations.load() - start;
+    cost.teardown           = seconds([&] {
+        graph.reset();
+        arena.reset();
+    });
+    return cost;
+}
+
+void report(const std::string& phase, double time, const std::string& detail) {
+    std::cout << std::left << std::setw(12) << phase << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << time << " s   " << detail << '\n';
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        if (!parse(argc, argv, options)) {
+            usage();
+            return 1;
+        }
+    } catch (const std::exception&) {
+        usage();
+        return 1;
+    }
+
+    std::mt19937_64 random(options.seed);
+    const std::string genome             = simulateGenome(options, random);
+    const std::vector<std::string> reads = simulateReads(genome, options, random);
+    std::cout << "genome " << genome.size() << " bases, " << reads.size() << " reads of " << options.readLength
+              << ", k = " << options.k << ", error rate " << options.errorRate << ", " << options.repeats
+              << " repeats of " << options.repeatLength << "\n\n";
+
+    std::size_t edges  = 0;
+    double extractTime = seconds([&] {
+        for (const auto& read : reads) {
+            genome::forEachKmer(read, options.k + 1, [&](genome::Kmer) { edges++; });
+        }
+    });
+    report("extract", extractTime, std::to_string(edges) + " (k + 1)-mers");
+
+    const std::size_t before = residentBytes();
+    genome::DeBruijnGraph graph(options.k);
+    double buildTime = seconds([&] {
+        for (const auto& read : reads) {
+            graph.addRead(read);
+        }
+    });
+    const std::size_t after      = residentBytes();
+    const std::size_t graphBytes = after > before ? after - before : 0;
+    report("build", buildTime,
+           std::to_string(graph.nodeCount()) + " k-mers, " + std::to_string(graph.edgeCount()) + " edges");
+
+    std::size_t sortedNodes = 0;
+    double sortTime         = seconds(
+        [&] { sortedNodes = genome::SortedGraph(options.k, reads, options.threads).nodeCount(); });
+    report("sort build", sortTime,
+           std::to_string(sortedNodes) + " k-mers, radix sorted on " + std::to_string(options.threads) + " threads");
+
+    // with errors the graph is built again the way the cleaning pipeline does it: (k + 1)-mers seen once
+    // are dropped by the count-min filter, then tips and bubbles are removed until none are left
+    const std::size_t rawNodes = graph.nodeCount();
+    double cleanTime           = seconds([&] {
+        if (options.errorRate > 0) {
+            graph = genome::buildFiltered(options.k, reads, genome::CleaningOptions{});
+            while (genome::removeTips(graph, 2 * options.k) + genome::popBubbles(graph, options.k + 1) > 0) {
+            }
+        }
+        genome::normalizeCoverage(graph);
+    });
+    report("clean", cleanTime, std::to_string(graph.edgeCount()) + " edges left");
+
+    std::optional<genome::UnitigGraph> unitigs;
+    double compactTime = seconds([&] { unitigs.emplace(graph); });
+    report("compact", compactTime,
+           std::to_string(unitigs->nodeCount()) + " junctions, " + std::to_string(unitigs->unitigs().size()) +
+               " unitigs");
+
+    std::string result;
+    double eulerTime = seconds([&] { result = genome::assembly(*unitigs); });
+    report("euler", eulerTime,
+           std::to_string(result.size()) + " bases spelled" + (result == genome ? ", genome recovered" : ""));
+
+    std::cout << "\npeak memory      " << peakBytes() / (1 << 20) << " MiB\n";
+    std::cout << "bytes per k-mer  " << std::setprecision(1)
+              << static_cast<double>(graphBytes) / static_cast<double>(std::max<std::size_t>(1, rawNodes))
+              << "\n\n";
+
+    std::cout << "storage  allocations     build  teardown\n";
+    for (bool useArena : {false, true}) {
+        StorageCost cost = measureStorage(reads, options.k, useArena);
+        std::cout << std::left << std::setw(7) << (useArena ? "arena" : "heap") << std::right << std::setw(13)
+                  << cost.allocations << std::setprecision(3) << std::setw(8) << cost.build << " s" << std::setw(8)
+                  << cost.teardown << " s\n";
+    }
+    std::cout << '\n';
+
+    // thread scaling of the disk-backed build and of the per-component contig extraction
+    std::ostringstream text;
+    for (const auto& read : reads) {
+        text << read << '\n';
+    }
+    const std::string lines = text.str();
+    std::cout << "threads  disk build  speedup     contigs  speedup\n";
+    double singleDisk    = 0;
+    double singleContigs = 0;
+    for (std::size_t threads = 1; threads <= options.threads; threads *= 2) {
+        genome::DiskOptions disk;
+        disk.threads = threads;
+        std::istringstream in(lines);
+        const auto graphFile = disk.directory / ("ga-benchmark-" + std::to_string(::getpid()) + ".bin");
+        double diskTime      = seconds([&] { genome::buildOnDisk(options.k, in, graphFile, disk); });
+        double contigsTime   = seconds([&] { genome::parallelContigs(graph, threads); });
+        std::filesystem::remove(graphFile);
+        if (threads == 1) {
+            singleDisk    = diskTime;
+            singleContigs = contigsTime;
+        }
+        std::cout << std::setw(7) << threads << std::setprecision(3) << std::setw(10) << diskTime << " s"
+                  << std::setprecision(2) << std::setw(8) << singleDisk / diskTime << "x" << std::setprecision(3)
+                  << std::setw(10) << contigsTime << " s" << std::setprecision(2) << std::setw(8)
+                  << singleContigs / contigsTime << "x\n";
+    }
+    return 0;
+}
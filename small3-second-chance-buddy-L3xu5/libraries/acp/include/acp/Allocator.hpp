@@ -11,6 +11,9 @@ class AllocatorWithPool: private PoolAllocator {
 public:
     AllocatorWithPool(std::size_t minPower, std::size_t maxPower);
 
+    // bytes of the block create of an object of sz bytes takes
+    std::size_t blockSize(const std::size_t sz) const { return static_cast<std::size_t>(1) << blockPower(sz); }
+
     template <class T, class... Args>
     T *create(Args &&...args) {
         auto *ptr = allocate(sizeof(T));
@@ -0,0 +1,49 @@
+#ifndef ACP_ARENA_POOL_HPP
+#define ACP_ARENA_POOL_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "acp/Pool.hpp"
+
+// PoolAllocator which grows: when every arena is full another one of 2 ^ maxPower bytes is mapped.
+// Arenas are aligned to their size and have their header in the page right before them, so
+// deallocate finds the owner by masking the pointer. Arenas left without allocations are unmapped,
+// except for up to spareArenas of them kept for the next allocations
+class ArenaPoolAllocator {
+public:
+    ArenaPoolAllocator(std::size_t minPower, std::size_t maxPower, std::size_t spareArenas = 1);
+
+    ArenaPoolAllocator(const ArenaPoolAllocator&)            = delete;
+    ArenaPoolAllocator& operator=(const ArenaPoolAllocator&) = delete;
+
+    void* allocate(std::size_t sz);
+
+    void deallocate(const void* ptr);
+
+    std::size_t arenaCount() const { return arenas.size(); }
+
+    ~ArenaPoolAllocator();
+
+private:
+    struct Arena;
+
+    std::size_t minPower;
+    std::size_t maxPower;
+    std::size_t spareArenas;
+    std::size_t pageSize;
+    // header pages before every arena
+    std::size_t headerSize;
+    // arenas start at multiples of it, the arena size or the page size if larger
+    std::size_t alignment;
+    std::vector<Arena*> arenas;
+    // arena which served the last allocation
+    Arena* current = nullptr;
+    std::size_t emptyArenas = 0;
+
+    Arena* map();
+    void unmap(Arena* arena);
+    Arena* owner(const void* ptr) const;
+};
+
+#endif  // ACP_ARENA_POOL_HPP
@@ -2,67 +2,190 @@
 #define ACP_CACHE_HPP
 
 #include <cstddef>
-#include <deque>
+#include <functional>
+#include <limits>
 #include <new>
 #include <ostream>
+#include <unordered_map>
+#include <vector>
 
-template <class Key, class KeyProvider, class Allocator>
+#include "acp/SecondChance.hpp"
+
+// cache of elements created by Allocator from their keys: elements live in slots found through
+// a hash index of their keys, and Policy decides which slot a miss on a full cache empties.
+// The default one is second chance, see SecondChance.hpp for the others.
+// Capacity is a number of elements, or with ByteBudget the bytes the elements take: an element
+// counts as Allocator::blockSize(sizeof(T)) if the allocator has it, as sizeof(T) otherwise
+struct ByteBudget {
+    std::size_t bytes;
+};
+
+template <class Key, class KeyProvider, class Allocator, class Policy = SecondChance, class Hash = std::hash<Key>>
 class Cache {
 public:
     template <class... AllocArgs>
     Cache(const std::size_t cache_size, AllocArgs &&...alloc_args)
-        : m_max_size(cache_size), m_alloc(std::forward<AllocArgs>(alloc_args)...) {}
+        : m_max_size(cache_size), m_alloc(std::forward<AllocArgs>(alloc_args)...), policy(cache_size) {
+        slots.reserve(cache_size);
+        index.reserve(cache_size);
+    }
+
+    // a miss evicts until the new element fits in budget, or while the allocator has no room for it;
+    // an element bigger than the whole budget is kept alone
+    template <class... AllocArgs>
+    Cache(const ByteBudget budget, AllocArgs &&...alloc_args)
+        : m_max_size(npos), m_max_bytes(budget.bytes), m_alloc(std::forward<AllocArgs>(alloc_args)...), policy(1) {}
+
+    std::size_t size() const { return index.size(); }
+
+    bool empty() const { return index.empty(); }
 
-    std::size_t size() const { return queue.size(); }
+    // bytes the elements count as
+    std::size_t bytes() const { return m_bytes; }
 
-    bool empty() const { return queue.empty(); }
+    const Allocator &allocator() const { return m_alloc; }
 
     template <class T>
     T &get(const Key &key);
 
+    // the element of key touched as a hit, nullptr if it is not cached; with Policy::concurrent_touch
+    // readers may call find concurrently as long as nothing calls get meanwhile
+    const KeyProvider *find(const Key &key);
+
     std::ostream &print(std::ostream &strm) const;
 
     friend std::ostream &operator<<(std::ostream &strm, const Cache &cache) { return cache.print(strm); }
 
     ~Cache() {
-        for (auto &elem : queue) {
-            m_alloc.template destroy<KeyProvider>(elem.first);
+        for (auto &slot : slots) {
+            if (slot.elem) {
+                m_alloc.template destroy<KeyProvider>(slot.elem);
+            }
         }
     }
 
 private:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    struct Slot {
+        Key key;
+        KeyProvider *elem;
+        std::size_t bytes;
+    };
+
+    using Index = std::unordered_map<Key, std::size_t, Hash>;
+
     const std::size_t m_max_size;
+    const std::size_t m_max_bytes = npos;
+    std::size_t m_bytes           = 0;
     Allocator m_alloc;
-    std::deque<std::pair<KeyProvider *, bool>> queue;
+    Policy policy;
+    std::vector<Slot> slots;
+    // slots emptied by evictions and not taken again yet
+    std::vector<std::size_t> holes;
+    Index index;
+    // index node of the last evicted key, reused for the next new one
+    typename Index::node_type spare;
+
+    template <class T>
+    std::size_t charge() const;
+
+    void evict();
 };
 
-template <class Key, class KeyProvider, class Allocator>
+template <class Key, class KeyProvider, class Allocator, class Policy, class Hash>
 template <class T>
-inline T &Cache<Key, KeyProvider, Allocator>::get(const Key &key) {
-    for (auto &[elem, used] : queue) {
-        if (*elem == key) {
-            used = true;
-            return static_cast<T &>(*elem);
+inline std::size_t Cache<Key, KeyProvider, Allocator, Policy, Hash>::charge() const {
+    if constexpr (requires { m_alloc.blockSize(sizeof(T)); }) {
+        return m_alloc.blockSize(sizeof(T));
+    } else {
+        return sizeof(T);
+    }
+}
+
+template <class Key, class KeyProvider, class Allocator, class Policy, class Hash>
+inline const KeyProvider *Cache<Key, KeyProvider, Allocator, Policy, Hash>::find(const Key &key) {
+    const auto found = index.find(key);
+    if (found == index.end()) {
+        return nullptr;
+    }
+    policy.touch(found->second);
+    return slots[found->second].elem;
+}
+
+template <class Key, class KeyProvider, class Allocator, class Policy, class Hash>
+inline void Cache<Key, KeyProvider, Allocator, Policy, Hash>::evict() {
+    const std::size_t victim = policy.evict();
+    spare                    = index.extract(slots[victim].key);
+    m_alloc.template destroy<KeyProvider>(slots[victim].elem);
+    m_bytes -= slots[victim].bytes;
+    slots[victim].elem = nullptr;
+    holes.push_back(victim);
+}
+
+template <class Key, class KeyProvider, class Allocator, class Policy, class Hash>
+template <class T>
+inline T &Cache<Key, KeyProvider, Allocator, Policy, Hash>::get(const Key &key) {
+    if (auto found = index.find(key); found != index.end()) {
+        policy.touch(found->second);
+        return static_cast<T &>(*slots[found->second].elem);
+    }
+    const std::size_t bytes = charge<T>();
+    while (!index.empty() && (index.size() >= m_max_size || m_bytes + bytes > m_max_bytes)) {
+        evict();
+    }
+    // an exception leaves the evicted slots holes
+    T *elem = nullptr;
+    while (elem == nullptr) {
+        try {
+            elem = m_alloc.template create<T>(key);
+        } catch (const std::bad_alloc &) {
+            if (m_max_bytes == npos || index.empty()) {
+                throw;
+            }
+            evict();
         }
     }
-    if (queue.size() < m_max_size) {
-        queue.emplace_front(m_alloc.template create<T>(key), false);
-        return static_cast<T &>(*queue.front().first);
+    const bool reuse       = !holes.empty();
+    const std::size_t slot = reuse ? holes.back() : slots.size();
+    bool indexed           = false;
+    try {
+        if (reuse) {
+            slots[slot] = Slot{key, elem, bytes};
+        } else {
+            slots.push_back(Slot{key, elem, bytes});
+        }
+        if (spare) {
+            spare.key()    = key;
+            spare.mapped() = slot;
+            index.insert(std::move(spare));
+        } else {
+            index.emplace(key, slot);
+        }
+        indexed = true;
+        policy.insert(slot, Hash{}(key));
+    } catch (...) {
+        // the new element goes again, a reused slot stays a hole
+        if (indexed) {
+            index.erase(key);
+        }
+        if (reuse) {
+            slots[slot].elem = nullptr;
+        } else if (slots.size() > slot) {
+            slots.pop_back();
+        }
+        m_alloc.template destroy<KeyProvider>(elem);
+        throw;
     }
-    std::pair<KeyProvider *, bool> &back = queue.back();
-    while (back.second) {
-        queue.pop_back();
-        queue.emplace_front(back.first, false);
-        back = queue.back();
+    if (reuse) {
+        holes.pop_back();
     }
-    queue.pop_back();
-    m_alloc.template destroy<KeyProvider>(back.first);
-    queue.emplace_front(m_alloc.template create<T>(key), false);
-    return static_cast<T &>(*queue.front().first);
+    m_bytes += bytes;
+    return *elem;
 }
 
-template <class Key, class KeyProvider, class Allocator>
-inline std::ostream &Cache<Key, KeyProvider, Allocator>::print(std::ostream &strm) const {
+template <class Key, class KeyProvider, class Allocator, class Policy, class Hash>
+inline std::ostream &Cache<Key, KeyProvider, Allocator, Policy, Hash>::print(std::ostream &strm) const {
     return strm << "<empty>\n";
 }
 
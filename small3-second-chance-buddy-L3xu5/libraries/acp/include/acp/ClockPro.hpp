@@ -0,0 +1,68 @@
+#ifndef ACP_CLOCK_PRO_HPP
+#define ACP_CLOCK_PRO_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// CLOCK-Pro of Jiang, Chen and Zhang: one clock holds hot and cold elements and the hashes of
+// recently evicted cold ones (tests). The cold hand evicts cold elements not referenced and keeps
+// them as tests, the hot hand turns unreferenced hot elements cold and the test hand forgets tests.
+// A miss on a test means the element was evicted too early: it comes back hot and the share of
+// cold elements grows, while tests forgotten unused make it shrink
+class ClockPro {
+public:
+    static constexpr bool concurrent_touch = true;
+
+    explicit ClockPro(std::size_t capacity);
+
+    void insert(std::size_t slot, std::size_t hash);
+
+    void touch(const std::size_t slot) {
+        std::atomic_ref<std::uint8_t>(referenced[slotNodes[slot]]).store(1, std::memory_order_relaxed);
+    }
+
+    std::size_t evict();
+
+private:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    enum class Kind : std::uint8_t { hot, cold, test };
+
+    struct Node {
+        std::size_t prev;
+        std::size_t next;
+        std::size_t hash;
+        std::size_t slot;
+        Kind kind;
+    };
+
+    std::vector<Node> nodes;
+    // per node, apart from the rest for touch
+    std::vector<std::uint8_t> referenced;
+    std::vector<std::size_t> freeNodes;
+    std::vector<std::size_t> slotNodes;
+    std::unordered_map<std::size_t, std::size_t> tests;
+    std::size_t handHot  = npos;
+    std::size_t handCold = npos;
+    std::size_t handTest = npos;
+    std::size_t hotCount  = 0;
+    std::size_t coldCount = 0;
+    std::size_t testCount = 0;
+    // resident elements, grows with the cache
+    std::size_t capacity;
+    // target number of cold elements
+    std::size_t coldTarget;
+
+    std::size_t newNode();
+    void link(std::size_t node);
+    void unlink(std::size_t node);
+    std::size_t runHandCold();
+    void runHandHot();
+    void runHandTest();
+};
+
+#endif  // ACP_CLOCK_PRO_HPP
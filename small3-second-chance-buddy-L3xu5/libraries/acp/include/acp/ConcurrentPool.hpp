@@ -0,0 +1,39 @@
+#ifndef ACP_CONCURRENT_POOL_HPP
+#define ACP_CONCURRENT_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+
+#include "acp/Pool.hpp"
+
+// thread-safe PoolAllocator: every thread keeps a magazine of free blocks per order and takes the
+// shared lock only to refill an empty magazine or to give back half of a full one.
+// Blocks sitting in the magazines of other threads are not seen by allocate, so std::bad_alloc may
+// come earlier than with a plain PoolAllocator; the magazines of the calling thread are always
+// given back before it is thrown. A thread returns its magazines when it exits
+class ConcurrentPoolAllocator {
+public:
+    static constexpr std::size_t magazineSize = 32;
+
+    ConcurrentPoolAllocator(std::size_t minPower, std::size_t maxPower);
+
+    ConcurrentPoolAllocator(const ConcurrentPoolAllocator&)            = delete;
+    ConcurrentPoolAllocator& operator=(const ConcurrentPoolAllocator&) = delete;
+
+    void* allocate(std::size_t sz);
+
+    void deallocate(const void* ptr);
+
+    ~ConcurrentPoolAllocator();
+
+private:
+    struct Shared;
+    struct Magazines;
+    struct ThreadCache;
+
+    std::shared_ptr<Shared> shared;
+
+    Magazines& magazines();
+};
+
+#endif  // ACP_CONCURRENT_POOL_HPP
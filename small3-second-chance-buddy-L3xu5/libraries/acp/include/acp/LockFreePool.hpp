@@ -0,0 +1,50 @@
+#ifndef ACP_LOCK_FREE_POOL_HPP
+#define ACP_LOCK_FREE_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+// lock-free buddy allocator with the same geometry as PoolAllocator, after the non-blocking buddy
+// system of Marotta et al.: every node of the block tree is one atomic state byte telling whether
+// the block itself is taken, whether each half holds allocations and whether each half is being
+// released. allocate claims a free node with one CAS and marks its ancestors bottom-up, deallocate
+// clears the marks top-down as far as the buddies are free, so operations on different blocks
+// only meet on the common ancestors and never wait for each other.
+// Unlike PoolAllocator the search for a free block starts at a per-thread position, so the first
+// half is not always the one picked
+class LockFreePoolAllocator {
+public:
+    LockFreePoolAllocator(std::size_t minPower, std::size_t maxPower);
+
+    LockFreePoolAllocator(const LockFreePoolAllocator&)            = delete;
+    LockFreePoolAllocator& operator=(const LockFreePoolAllocator&) = delete;
+
+    void* allocate(std::size_t sz);
+
+    void deallocate(const void* ptr);
+
+private:
+    struct FreePool {
+        void operator()(std::byte* memory) const { std::free(memory); }
+    };
+
+    std::size_t minPower;
+    std::size_t maxPower;
+    // owned before the tree and the powers are allocated, so it is freed when that throws
+    std::unique_ptr<std::byte, FreePool> pool;
+    // node 1 is the whole pool, the halves of node n are 2n and 2n + 1
+    std::unique_ptr<std::atomic<std::uint8_t>[]> tree;
+    // power of every block handed out, indexed by its first smallest block
+    std::vector<std::uint8_t> powers;
+
+    std::size_t power(std::size_t node) const;
+    std::size_t tryAllocate(std::size_t node);
+    void release(std::size_t node, std::size_t upperPower);
+    void unmark(std::size_t node, std::size_t upperPower);
+};
+
+#endif  // ACP_LOCK_FREE_POOL_HPP
@@ -2,31 +2,79 @@
 #define ACP_POOL_HPP
 
 #include <cstddef>
-#include <map>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
 #include <new>
-#include <unordered_set>
+#include <vector>
 
+// buddy allocator over a pool of 2 ^ maxPower bytes handing out blocks of 2 ^ minPower bytes or more.
+// Free blocks of every order are kept in doubly linked lists stored inside the blocks themselves,
+// the tree of blocks is described by two bitmaps in heap order (split nodes and free blocks),
+// and the buddy of a block is found by xoring its offset with its size, so allocate and deallocate
+// take O(maxPower - minPower) steps and never allocate metadata
 class PoolAllocator {
 public:
     PoolAllocator(std::size_t minPower, std::size_t maxPower);
 
+    // over 2 ^ maxPower bytes at memory owned by the caller
+    PoolAllocator(std::size_t minPower, std::size_t maxPower, void* memory);
+
+    PoolAllocator(const PoolAllocator&)            = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+
     void* allocate(std::size_t sz);
 
+    // nullptr instead of std::bad_alloc when no block fits
+    void* tryAllocate(std::size_t sz) noexcept;
+
     void deallocate(const void* ptr);
-    ~PoolAllocator();
-    class Node {
-    public:
-        Node(void* addr, Node* twin, std::size_t power, bool used);
-        void* addr;
-        Node* twin;
-        std::size_t power;
-        bool used;
-    };
+
+    // power of the block allocate(sz) hands out, may exceed maxPower
+    std::size_t blockPower(std::size_t sz) const;
+
+    // number of the smallest block starting at ptr, below blockCount()
+    std::size_t blockIndex(const void* ptr) const;
+
+    std::size_t blockCount() const { return static_cast<std::size_t>(1) << (maxPower - minPower); }
+
+    // bytes in free blocks, and the size of the largest of them, 0 when the pool is full
+    std::size_t freeBytes() const;
+    std::size_t largestFreeBlock() const;
 
 private:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    struct FreePool {
+        void operator()(std::byte* memory) const { std::free(memory); }
+    };
+
+    // offsets of the neighbours in the free list of the same order
+    struct Link {
+        std::size_t prev;
+        std::size_t next;
+    };
+
     std::size_t minPower;
-    std::map<std::size_t, std::unordered_set<Node*>> freeNodes;
-    std::map<void const*, Node> pool;
-    void eraseFromFreeNodes(Node* node);
+    std::size_t maxPower;
+    std::byte* pool;
+    // the pool when it was allocated here, initialized before the metadata so that it is freed
+    // as well when allocating the metadata throws
+    std::unique_ptr<std::byte, FreePool> ownedPool;
+    // first free block of every order, indexed by power - minPower
+    std::vector<std::size_t> heads;
+    std::vector<std::uint64_t> splitBits;
+    std::vector<std::uint64_t> freeBits;
+    // links of blocks too small to hold them, indexed by offset >> minPower; empty otherwise
+    std::vector<Link> sideLinks;
+
+    PoolAllocator(std::size_t minPower, std::size_t maxPower, void* memory, bool owned);
+
+    std::size_t node(std::size_t offset, std::size_t power) const;
+    Link& link(std::size_t offset);
+    void push(std::size_t offset, std::size_t power);
+    void remove(std::size_t offset, std::size_t power);
 };
+
 #endif  // ACP_POOL_HPP
@@ -0,0 +1,66 @@
+#ifndef ACP_S3_FIFO_HPP
+#define ACP_S3_FIFO_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// S3-FIFO of Yang et al.: new elements enter a small FIFO of about a tenth of the cache, the ones
+// hit more than once there move to the main FIFO and the others leave a ghost of their hash.
+// Elements whose ghost is still remembered go straight to the main FIFO, which reinserts
+// the elements hit since they got there, up to three times.
+// Ghosts are kept in a counting filter, so a few foreign hashes may pass for ghosts
+class S3Fifo {
+public:
+    static constexpr bool concurrent_touch = true;
+
+    explicit S3Fifo(std::size_t capacity);
+
+    void insert(std::size_t slot, std::size_t hash);
+
+    void touch(const std::size_t slot) {
+        std::atomic_ref<std::uint8_t> freq(nodes[slot].freq);
+        // increments racing with each other may be lost, the count is an estimate anyway
+        if (const std::uint8_t current = freq.load(std::memory_order_relaxed); current < maxFreq) {
+            freq.store(current + 1, std::memory_order_relaxed);
+        }
+    }
+
+    std::size_t evict();
+
+private:
+    static constexpr std::size_t npos     = std::numeric_limits<std::size_t>::max();
+    static constexpr std::uint8_t maxFreq = 3;
+
+    struct Node {
+        // next newer element of the same FIFO
+        std::size_t next;
+        std::size_t hash;
+        std::uint8_t freq;
+    };
+
+    struct Fifo {
+        std::size_t oldest = npos;
+        std::size_t newest = npos;
+        std::size_t size   = 0;
+    };
+
+    std::vector<Node> nodes;
+    Fifo small;
+    Fifo main;
+    // ring of the latest ghosts and the number of them per filter cell
+    std::vector<std::size_t> ghosts;
+    std::size_t ghostNext  = 0;
+    std::size_t ghostCount = 0;
+    std::vector<std::uint16_t> ghostCells;
+
+    void push(Fifo& fifo, std::size_t slot);
+    std::size_t pop(Fifo& fifo);
+    std::size_t cell(std::size_t hash) const;
+    bool isGhost(std::size_t hash) const;
+    void addGhost(std::size_t hash);
+};
+
+#endif  // ACP_S3_FIFO_HPP
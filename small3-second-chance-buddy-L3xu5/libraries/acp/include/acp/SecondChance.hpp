@@ -0,0 +1,42 @@
+#ifndef ACP_SECOND_CHANCE_HPP
+#define ACP_SECOND_CHANCE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Eviction policies of Cache work on slot numbers: insert tells a slot got an element (slots freed
+// by evict are reused), touch tells it was hit and evict picks the slot to empty next.
+// touch may run concurrently with other touch calls when concurrent_touch is true.
+
+// second chance in CLOCK form: slots make a ring with a reference bit each, the hand moves past
+// the referenced slots clearing their bits and evicts the first one not referenced
+class SecondChance {
+public:
+    static constexpr bool concurrent_touch = true;
+
+    explicit SecondChance(std::size_t capacity);
+
+    void insert(std::size_t slot, std::size_t hash);
+
+    void touch(const std::size_t slot) {
+        const std::uint64_t mark = std::uint64_t{1} << (slot % 64);
+        std::atomic_ref<std::uint64_t> word(referenced[slot / 64]);
+        // a load first keeps the cache line shared while the hot elements stay marked
+        if (!(word.load(std::memory_order_relaxed) & mark)) {
+            word.fetch_or(mark, std::memory_order_relaxed);
+        }
+    }
+
+    std::size_t evict();
+
+private:
+    std::vector<std::uint64_t> referenced;
+    std::vector<std::uint64_t> resident;
+    std::size_t slots = 0;
+    // oldest slot, the next one to look at
+    std::size_t hand = 0;
+};
+
+#endif  // ACP_SECOND_CHANCE_HPP
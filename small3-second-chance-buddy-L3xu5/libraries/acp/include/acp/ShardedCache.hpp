@@ -0,0 +1,100 @@
+#ifndef ACP_SHARDED_CACHE_HPP
+#define ACP_SHARDED_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "acp/Cache.hpp"
+
+// thread-safe Cache: keys are spread by hash over a power of two shards, each one a Cache of its own
+// with its own Policy state, index and Allocator built from alloc_args. With Policy::concurrent_touch
+// hits take the shard lock shared and only touch the element, so concurrent hits never wait for
+// each other; misses, and hits of the other policies, take it exclusively
+template <class Key, class KeyProvider, class Allocator, class Policy = SecondChance, class Hash = std::hash<Key>>
+class ShardedCache {
+public:
+    // cache_size is split evenly between the shards, rounded up
+    template <class... AllocArgs>
+    ShardedCache(std::size_t shard_count, std::size_t cache_size, const AllocArgs &...alloc_args);
+
+    // calls f with the element of key, creating it as T on a miss, and returns what f returns.
+    // Elements are shared between threads, so f only gets them as const
+    template <class T, class F>
+    decltype(auto) get(const Key &key, F &&f);
+
+    std::size_t size() const;
+
+    std::size_t shard_count() const { return shards.size(); }
+
+private:
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        Cache<Key, KeyProvider, Allocator, Policy, Hash> cache;
+
+        template <class... AllocArgs>
+        Shard(const std::size_t cache_size, const AllocArgs &...alloc_args) : cache(cache_size, alloc_args...) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    unsigned shift = 64;
+
+    Shard &shard(const Key &key);
+};
+
+template <class Key, class KeyProvider, class Allocator, class Policy, class Hash>
+template <class... AllocArgs>
+ShardedCache<Key, KeyProvider, Allocator, Policy, Hash>::ShardedCache(const std::size_t shard_count,
+                                                                      const std::size_t cache_size,
+                                                                      const AllocArgs &...alloc_args) {
+    std::size_t count = 1;
+    while (count < shard_count) {
+        count *= 2;
+        --shift;
+    }
+    shards.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        shards.push_back(std::make_unique<Shard>((cache_size + count - 1) / count, alloc_args...));
+    }
+}
+
+// the top bits of the mixed hash pick the shard, the index inside it uses the low ones
+template <class Key, class KeyProvider, class Allocator, class Policy, class Hash>
+inline auto ShardedCache<Key, KeyProvider, Allocator, Policy, Hash>::shard(const Key &key) -> Shard & {
+    if (shards.size() == 1) {
+        return *shards.front();
+    }
+    const std::uint64_t mixed = static_cast<std::uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ULL;
+    return *shards[mixed >> shift];
+}
+
+template <class Key, class KeyProvider, class Allocator, class Policy, class Hash>
+template <class T, class F>
+inline decltype(auto) ShardedCache<Key, KeyProvider, Allocator, Policy, Hash>::get(const Key &key, F &&f) {
+    Shard &owner = shard(key);
+    if constexpr (Policy::concurrent_touch) {
+        std::shared_lock lock(owner.mutex);
+        if (const KeyProvider *elem = owner.cache.find(key)) {
+            return f(static_cast<const T &>(*elem));
+        }
+    }
+    // another thread may have added key meanwhile, get then finds it
+    std::unique_lock lock(owner.mutex);
+    return f(static_cast<const T &>(owner.cache.template get<T>(key)));
+}
+
+template <class Key, class KeyProvider, class Allocator, class Policy, class Hash>
+inline std::size_t ShardedCache<Key, KeyProvider, Allocator, Policy, Hash>::size() const {
+    std::size_t total = 0;
+    for (const auto &owner : shards) {
+        std::shared_lock lock(owner->mutex);
+        total += owner->cache.size();
+    }
+    return total;
+}
+
+#endif  // ACP_SHARDED_CACHE_HPP
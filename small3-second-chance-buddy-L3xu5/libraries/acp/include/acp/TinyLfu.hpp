@@ -0,0 +1,78 @@
+#ifndef ACP_TINY_LFU_HPP
+#define ACP_TINY_LFU_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// W-TinyLFU of Einziger, Friedman and Manes: new elements enter an LRU window of about a hundredth
+// of the cache, the main part is a segmented LRU (probation and protected, the latter about 80%).
+// An element leaving the window replaces the oldest one in probation only if a count-min sketch of
+// recent accesses rates it higher, otherwise it is the one evicted.
+// Hits reorder the lists, so touch needs exclusive access
+class WTinyLfu {
+public:
+    static constexpr bool concurrent_touch = false;
+
+    explicit WTinyLfu(std::size_t capacity);
+
+    void insert(std::size_t slot, std::size_t hash);
+
+    void touch(std::size_t slot);
+
+    std::size_t evict();
+
+private:
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    enum class Segment : std::uint8_t { window, probation, protect };
+
+    struct Node {
+        std::size_t prev;
+        std::size_t next;
+        std::size_t hash;
+        Segment segment;
+    };
+
+    struct Lru {
+        std::size_t newest = npos;
+        std::size_t oldest = npos;
+        std::size_t size   = 0;
+    };
+
+    // four rows of 4-bit counters packed in bytes' halves; every counter is halved after
+    // ten times as many additions as there are counters in a row, so old popularity fades
+    class Sketch {
+    public:
+        explicit Sketch(std::size_t width);
+
+        void add(std::size_t hash);
+
+        unsigned estimate(std::size_t hash) const;
+
+        std::size_t width() const { return rowWidth; }
+
+    private:
+        std::size_t rowWidth;
+        std::vector<std::uint8_t> counters;
+        std::size_t additions = 0;
+
+        std::size_t cell(std::size_t hash, std::size_t row) const;
+        unsigned get(std::size_t cell) const;
+    };
+
+    std::vector<Node> nodes;
+    Lru window;
+    Lru probation;
+    Lru protect;
+    Sketch sketch;
+    std::size_t capacity;
+
+    std::size_t windowTarget() const;
+    Lru& lru(Segment segment);
+    void push(Segment segment, std::size_t slot);
+    void remove(std::size_t slot);
+};
+
+#endif  // ACP_TINY_LFU_HPP
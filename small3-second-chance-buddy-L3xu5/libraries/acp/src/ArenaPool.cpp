@@ -0,0 +1,120 @@
+#include "acp/ArenaPool.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+struct ArenaPoolAllocator::Arena {
+    PoolAllocator pool;
+    std::size_t live = 0;
+    // start and length of the whole mapping, header included
+    void* mapping;
+    std::size_t length;
+
+    Arena(const std::size_t minPower, const std::size_t maxPower, void* memory, void* mapping, std::size_t length)
+        : pool(minPower, maxPower, memory), mapping(mapping), length(length) {}
+};
+
+namespace {
+
+std::size_t roundUp(const std::size_t value, const std::size_t step) { return (value + step - 1) / step * step; }
+
+}  // namespace
+
+ArenaPoolAllocator::ArenaPoolAllocator(const std::size_t minPower, const std::size_t maxPower,
+                                       const std::size_t spareArenas)
+    : minPower(minPower),
+      maxPower(std::max(minPower, maxPower)),
+      spareArenas(spareArenas),
+      pageSize(static_cast<std::size_t>(sysconf(_SC_PAGESIZE))),
+      headerSize(roundUp(sizeof(Arena), pageSize)),
+      alignment(std::max(static_cast<std::size_t>(1) << this->maxPower, pageSize)) {}
+
+ArenaPoolAllocator::~ArenaPoolAllocator() {
+    for (Arena* arena : arenas) {
+        // the arena lives inside the mapping, so where it is has to be read before destroying it
+        void* mapping      = arena->mapping;
+        std::size_t length = arena->length;
+        arena->~Arena();
+        munmap(mapping, length);
+    }
+}
+
+ArenaPoolAllocator::Arena* ArenaPoolAllocator::map() {
+    const std::size_t body = roundUp(static_cast<std::size_t>(1) << maxPower, pageSize);
+    // enough to find an aligned start with a header page before it, the rest is unmapped right away
+    const std::size_t reserved = headerSize + body + alignment;
+    void* reservation          = mmap(nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reservation == MAP_FAILED)
+        throw std::bad_alloc{};
+    const auto base  = reinterpret_cast<std::uintptr_t>(reservation);
+    const auto start = roundUp(base + headerSize, alignment);
+    const auto first = start - headerSize;
+    const auto last  = start + body;
+    if (first > base)
+        munmap(reservation, first - base);
+    if (base + reserved > last)
+        munmap(reinterpret_cast<void*>(last), base + reserved - last);
+    auto* header = reinterpret_cast<void*>(first);
+    auto* memory = reinterpret_cast<void*>(start);
+    Arena* arena;
+    try {
+        arena = new (header) Arena(minPower, maxPower, memory, header, headerSize + body);
+    } catch (...) {
+        munmap(header, headerSize + body);
+        throw;
+    }
+    try {
+        arenas.push_back(arena);
+    } catch (...) {
+        arena->~Arena();
+        munmap(header, headerSize + body);
+        throw;
+    }
+    emptyArenas++;
+    return arena;
+}
+
+void ArenaPoolAllocator::unmap(Arena* arena) {
+    arenas.erase(std::find(arenas.begin(), arenas.end(), arena));
+    if (current == arena)
+        current = nullptr;
+    void* mapping      = arena->mapping;
+    std::size_t length = arena->length;
+    arena->~Arena();
+    munmap(mapping, length);
+}
+
+ArenaPoolAllocator::Arena* ArenaPoolAllocator::owner(const void* ptr) const {
+    const auto start = reinterpret_cast<std::uintptr_t>(ptr) & ~(alignment - 1);
+    return std::launder(reinterpret_cast<Arena*>(start - headerSize));
+}
+
+void* ArenaPoolAllocator::allocate(const std::size_t sz) {
+    if (sz > (static_cast<std::size_t>(1) << maxPower))
+        throw std::bad_alloc{};
+    void* ptr = current != nullptr ? current->pool.tryAllocate(sz) : nullptr;
+    for (auto it = arenas.begin(); ptr == nullptr && it != arenas.end(); ++it) {
+        if (*it != current && (ptr = (*it)->pool.tryAllocate(sz)) != nullptr)
+            current = *it;
+    }
+    if (ptr == nullptr) {
+        current = map();
+        ptr     = current->pool.tryAllocate(sz);
+    }
+    if (current->live++ == 0)
+        emptyArenas--;
+    return ptr;
+}
+
+void ArenaPoolAllocator::deallocate(const void* ptr) {
+    Arena* arena = owner(ptr);
+    arena->pool.deallocate(ptr);
+    if (--arena->live == 0 && ++emptyArenas > spareArenas) {
+        unmap(arena);
+        emptyArenas--;
+    }
+}
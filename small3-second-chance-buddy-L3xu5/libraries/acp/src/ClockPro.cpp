@@ -0,0 +1,168 @@
+#include "acp/ClockPro.hpp"
+
+#include <algorithm>
+
+ClockPro::ClockPro(const std::size_t capacity)
+    : capacity(std::max<std::size_t>(1, capacity)), coldTarget(this->capacity) {
+    nodes.reserve(2 * this->capacity);
+    referenced.reserve(2 * this->capacity);
+    slotNodes.reserve(this->capacity);
+    tests.reserve(this->capacity);
+}
+
+std::size_t ClockPro::newNode() {
+    if (!freeNodes.empty()) {
+        const std::size_t node = freeNodes.back();
+        freeNodes.pop_back();
+        return node;
+    }
+    nodes.emplace_back();
+    referenced.push_back(0);
+    return nodes.size() - 1;
+}
+
+// the new node goes right behind the hot hand, the cold hand takes it if the two met
+void ClockPro::link(const std::size_t node) {
+    if (handHot == npos) {
+        nodes[node].prev = node;
+        nodes[node].next = node;
+        handHot          = node;
+        handCold         = node;
+        handTest         = node;
+        return;
+    }
+    const std::size_t next = handHot;
+    const std::size_t prev = nodes[next].prev;
+    nodes[node].prev       = prev;
+    nodes[node].next       = next;
+    nodes[prev].next       = node;
+    nodes[next].prev       = node;
+    if (handCold == handHot) {
+        handCold = node;
+    }
+}
+
+// hands on the node step back, so that moving them forward lands on its successor
+void ClockPro::unlink(const std::size_t node) {
+    const std::size_t prev = nodes[node].prev;
+    const std::size_t next = nodes[node].next;
+    if (next == node) {
+        handHot  = npos;
+        handCold = npos;
+        handTest = npos;
+    } else {
+        for (std::size_t* hand : {&handHot, &handCold, &handTest}) {
+            if (*hand == node) {
+                *hand = prev;
+            }
+        }
+        nodes[prev].next = next;
+        nodes[next].prev = prev;
+    }
+    freeNodes.push_back(node);
+}
+
+void ClockPro::insert(const std::size_t slot, const std::size_t hash) {
+    if (slot >= slotNodes.size()) {
+        slotNodes.resize(slot + 1, npos);
+    }
+    capacity  = std::max(capacity, hotCount + coldCount + 1);
+    Kind kind = Kind::cold;
+    if (const auto found = tests.find(hash); found != tests.end()) {
+        // evicted too early: the cold share grows and the element comes back hot
+        unlink(found->second);
+        tests.erase(found);
+        --testCount;
+        coldTarget = std::min(capacity, coldTarget + 1);
+        kind       = Kind::hot;
+    }
+    const std::size_t node = newNode();
+    nodes[node].hash       = hash;
+    nodes[node].slot       = slot;
+    nodes[node].kind       = kind;
+    referenced[node]       = 0;
+    slotNodes[slot]        = node;
+    ++(kind == Kind::hot ? hotCount : coldCount);
+    link(node);
+}
+
+std::size_t ClockPro::runHandCold() {
+    const std::size_t node = handCold;
+    std::size_t freed      = npos;
+    if (nodes[node].kind == Kind::cold) {
+        --coldCount;
+        if (referenced[node]) {
+            referenced[node] = 0;
+            nodes[node].kind = Kind::hot;
+            ++hotCount;
+        } else {
+            nodes[node].kind = Kind::test;
+            freed            = nodes[node].slot;
+            slotNodes[freed] = npos;
+            ++testCount;
+            // a test left by another key of the same hash is replaced
+            if (const auto [found, added] = tests.try_emplace(nodes[node].hash, node); !added) {
+                unlink(found->second);
+                found->second = node;
+                --testCount;
+            }
+            while (testCount > capacity) {
+                runHandTest();
+            }
+        }
+    }
+    handCold = nodes[handCold].next;
+    while (capacity - coldTarget < hotCount) {
+        runHandHot();
+    }
+    return freed;
+}
+
+void ClockPro::runHandHot() {
+    if (handHot == handTest) {
+        runHandTest();
+    }
+    const std::size_t node = handHot;
+    if (nodes[node].kind == Kind::hot) {
+        if (referenced[node]) {
+            referenced[node] = 0;
+        } else {
+            nodes[node].kind = Kind::cold;
+            --hotCount;
+            ++coldCount;
+        }
+    }
+    handHot = nodes[handHot].next;
+}
+
+// unlike the original the test hand does not push the cold hand, so one evict frees exactly one slot
+void ClockPro::runHandTest() {
+    if (handTest == npos) {
+        return;
+    }
+    const std::size_t node = handTest;
+    if (nodes[node].kind == Kind::test) {
+        // forgotten unused: the cold share shrinks
+        tests.erase(nodes[node].hash);
+        unlink(node);
+        --testCount;
+        if (coldTarget > 1) {
+            --coldTarget;
+        }
+    }
+    if (handTest != npos) {
+        handTest = nodes[handTest].next;
+    }
+}
+
+std::size_t ClockPro::evict() {
+    capacity = std::max(capacity, hotCount + coldCount);
+    while (true) {
+        while (coldCount == 0) {
+            runHandHot();
+        }
+        if (const std::size_t freed = runHandCold(); freed != npos) {
+            return freed;
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#include "acp/ConcurrentPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+
+// allocators are told apart by a number never reused, unlike their addresses
+std::atomic<std::uint64_t> allocatorIds{0};
+
+}  // namespace
+
+struct ConcurrentPoolAllocator::Magazines {
+    // free blocks of every order, indexed by power - minPower; never grow past magazineSize
+    std::vector<std::vector<void*>> blocks;
+};
+
+struct ConcurrentPoolAllocator::Shared {
+    PoolAllocator core;
+    std::mutex mutex;
+    std::size_t minPower;
+    std::size_t maxPower;
+    // power of every block handed out, indexed by its first smallest block
+    std::vector<std::uint8_t> powers;
+    std::uint64_t id;
+
+    Shared(const std::size_t minPower, const std::size_t maxPower)
+        : core(minPower, maxPower), minPower(minPower), maxPower(std::max(minPower, maxPower)),
+          powers(core.blockCount()), id(allocatorIds.fetch_add(1, std::memory_order_relaxed) + 1) {}
+
+    // blocks moved at once, fewer for the orders having only a few blocks
+    std::size_t batch(const std::size_t power) const {
+        return std::min(magazineSize / 2, std::max<std::size_t>(1, (core.blockCount() >> (power - minPower)) / 16));
+    }
+
+    bool refill(std::vector<void*>& magazine, const std::size_t power) {
+        std::lock_guard lock(mutex);
+        for (std::size_t i = batch(power); i > 0; i--) {
+            void* ptr = core.tryAllocate(static_cast<std::size_t>(1) << power);
+            if (ptr == nullptr)
+                break;
+            magazine.push_back(ptr);
+        }
+        return !magazine.empty();
+    }
+
+    // the coldest blocks go back, the recently freed ones stay
+    void flush(std::vector<void*>& magazine, const std::size_t power) {
+        const std::size_t count = std::min(batch(power), magazine.size());
+        {
+            std::lock_guard lock(mutex);
+            for (std::size_t i = 0; i < count; i++) {
+                core.deallocate(magazine[i]);
+            }
+        }
+        magazine.erase(magazine.begin(), magazine.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+
+    void giveBack(Magazines& magazines) {
+        std::lock_guard lock(mutex);
+        for (auto& magazine : magazines.blocks) {
+            for (void* ptr : magazine) {
+                core.deallocate(ptr);
+            }
+            magazine.clear();
+        }
+    }
+};
+
+struct ConcurrentPoolAllocator::ThreadCache {
+    struct Entry {
+        // compared before owner, which tells whether the allocator is still alive
+        std::uint64_t id;
+        std::weak_ptr<Shared> owner;
+        Magazines magazines;
+    };
+
+    // list nodes never move, so the magazines of the allocator used last can be kept by address;
+    // its id is never reused, so a stale pointer is never matched
+    std::list<Entry> entries;
+    std::uint64_t lastId     = 0;
+    Magazines* lastMagazines = nullptr;
+
+    ~ThreadCache() {
+        for (auto& entry : entries) {
+            if (auto shared = entry.owner.lock())
+                shared->giveBack(entry.magazines);
+        }
+    }
+};
+
+ConcurrentPoolAllocator::ConcurrentPoolAllocator(const std::size_t minPower, const std::size_t maxPower)
+    : shared(std::make_shared<Shared>(minPower, maxPower)) {}
+
+ConcurrentPoolAllocator::~ConcurrentPoolAllocator() = default;
+
+ConcurrentPoolAllocator::Magazines& ConcurrentPoolAllocator::magazines() {
+    thread_local ThreadCache cache;
+    if (cache.lastId == shared->id)
+        return *cache.lastMagazines;
+    Magazines* found = nullptr;
+    for (auto it = cache.entries.begin(); it != cache.entries.end();) {
+        if (it->owner.expired()) {
+            // left by an allocator destroyed since
+            it = cache.entries.erase(it);
+            continue;
+        }
+        if (it->id == shared->id)
+            found = &it->magazines;
+        ++it;
+    }
+    if (found == nullptr) {
+        auto& entry = cache.entries.emplace_back(ThreadCache::Entry{shared->id, shared, {}});
+        entry.magazines.blocks.resize(shared->maxPower - shared->minPower + 1);
+        for (auto& magazine : entry.magazines.blocks) {
+            magazine.reserve(magazineSize);
+        }
+        found = &entry.magazines;
+    }
+    cache.lastId        = shared->id;
+    cache.lastMagazines = found;
+    return *found;
+}
+
+void* ConcurrentPoolAllocator::allocate(const std::size_t sz) {
+    const std::size_t power = shared->core.blockPower(sz);
+    if (power > shared->maxPower)
+        throw std::bad_alloc{};
+    Magazines& own               = magazines();
+    std::vector<void*>& magazine = own.blocks[power - shared->minPower];
+    if (magazine.empty() && !shared->refill(magazine, power)) {
+        // smaller free blocks of this thread may merge into one that fits
+        shared->giveBack(own);
+        if (!shared->refill(magazine, power))
+            throw std::bad_alloc{};
+    }
+    void* ptr = magazine.back();
+    magazine.pop_back();
+    shared->powers[shared->core.blockIndex(ptr)] = static_cast<std::uint8_t>(power);
+    return ptr;
+}
+
+void ConcurrentPoolAllocator::deallocate(const void* ptr) {
+    const std::size_t power      = shared->powers[shared->core.blockIndex(ptr)];
+    std::vector<void*>& magazine = magazines().blocks[power - shared->minPower];
+    if (magazine.size() == magazineSize)
+        shared->flush(magazine, power);
+    magazine.push_back(const_cast<void*>(ptr));
+}
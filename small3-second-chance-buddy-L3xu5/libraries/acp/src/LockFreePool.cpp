@@ -0,0 +1,159 @@
+#include "acp/LockFreePool.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <thread>
+
+namespace {
+
+// state bits of a node: allocations in the right or left half, the right or left half being released,
+// the node allocated as a whole
+constexpr std::uint8_t occRight  = 0x01;
+constexpr std::uint8_t occLeft   = 0x02;
+constexpr std::uint8_t coalRight = 0x04;
+constexpr std::uint8_t coalLeft  = 0x08;
+constexpr std::uint8_t occ       = 0x10;
+constexpr std::uint8_t busy      = occ | occLeft | occRight;
+
+bool isLeft(const std::size_t node) { return node % 2 == 0; }
+
+std::uint8_t occBit(const std::size_t child) { return isLeft(child) ? occLeft : occRight; }
+
+std::uint8_t coalBit(const std::size_t child) { return isLeft(child) ? coalLeft : coalRight; }
+
+std::uint8_t buddyOccBit(const std::size_t child) { return isLeft(child) ? occRight : occLeft; }
+
+std::uint8_t buddyCoalBit(const std::size_t child) { return isLeft(child) ? coalRight : coalLeft; }
+
+std::size_t evalCurPower(const std::size_t sz) {
+    std::size_t curPower = 0;
+    while (sz > (static_cast<std::size_t>(1) << curPower)) {
+        curPower++;
+    }
+    return curPower;
+}
+
+}  // namespace
+
+LockFreePoolAllocator::LockFreePoolAllocator(const std::size_t minPower, const std::size_t maxPower)
+    : minPower(minPower),
+      maxPower(std::max(minPower, maxPower)),
+      pool(static_cast<std::byte*>(std::malloc(static_cast<std::size_t>(1) << this->maxPower))),
+      tree(std::make_unique<std::atomic<std::uint8_t>[]>(static_cast<std::size_t>(2) << (this->maxPower - minPower))),
+      powers(static_cast<std::size_t>(1) << (this->maxPower - minPower)) {
+    if (pool == nullptr)
+        throw std::bad_alloc{};
+}
+
+std::size_t LockFreePoolAllocator::power(const std::size_t node) const {
+    return maxPower - (static_cast<std::size_t>(std::bit_width(node)) - 1);
+}
+
+// 0 on success, otherwise the node found taken: the node itself or an ancestor allocated as a whole
+std::size_t LockFreePoolAllocator::tryAllocate(const std::size_t node) {
+    std::uint8_t expected = 0;
+    if (!tree[node].compare_exchange_strong(expected, busy))
+        return node;
+    std::size_t current = node;
+    while (current > 1) {
+        const std::size_t child = current;
+        current /= 2;
+        std::uint8_t state = tree[current].load();
+        std::uint8_t marked;
+        do {
+            if (state & occ) {
+                release(node, power(child));
+                return current;
+            }
+            // an allocation below cancels the release of this half
+            marked = static_cast<std::uint8_t>((state & ~coalBit(child)) | occBit(child));
+        } while (!tree[current].compare_exchange_weak(state, marked));
+    }
+    return 0;
+}
+
+// frees node and clears the marks it left on its ancestors up to the one of power upperPower
+void LockFreePoolAllocator::release(const std::size_t node, const std::size_t upperPower) {
+    if (power(node) == upperPower) {
+        tree[node].store(0);
+        return;
+    }
+    // announce the release on the way up, stopping below a buddy which stays allocated
+    std::size_t runner  = node;
+    std::size_t current = node / 2;
+    while (true) {
+        std::uint8_t state = tree[current].load();
+        std::uint8_t marked;
+        do {
+            marked = static_cast<std::uint8_t>(state | coalBit(runner));
+        } while (!tree[current].compare_exchange_weak(state, marked));
+        if ((marked & buddyOccBit(runner)) && !(marked & buddyCoalBit(runner)))
+            break;
+        runner  = current;
+        current = current / 2;
+        if (power(runner) >= upperPower)
+            break;
+    }
+    tree[node].store(0);
+    unmark(node, upperPower);
+}
+
+void LockFreePoolAllocator::unmark(const std::size_t node, const std::size_t upperPower) {
+    std::size_t current = node;
+    std::size_t child;
+    std::uint8_t cleared;
+    do {
+        child              = current;
+        current            = current / 2;
+        std::uint8_t state = tree[current].load();
+        do {
+            // an allocation took this half over meanwhile
+            if (!(state & coalBit(child)))
+                return;
+            cleared = static_cast<std::uint8_t>(state & ~(occBit(child) | coalBit(child)));
+        } while (!tree[current].compare_exchange_weak(state, cleared));
+    } while (power(current) < upperPower && !(cleared & buddyOccBit(child)));
+}
+
+void* LockFreePoolAllocator::allocate(const std::size_t sz) {
+    const std::size_t curPower = std::max(minPower, evalCurPower(sz));
+    if (curPower > maxPower)
+        throw std::bad_alloc{};
+    const std::size_t first = static_cast<std::size_t>(1) << (maxPower - curPower);
+    const std::size_t count = first;
+    // threads start looking at different places so that they rarely race for the same nodes
+    thread_local const std::size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    const std::size_t start             = hint % count;
+    std::size_t i                       = start;
+    std::size_t scanned                 = 0;
+    while (scanned < count) {
+        const std::size_t node = first + i;
+        std::size_t skip       = 1;
+        if (tree[node].load() == 0) {
+            const std::size_t failedAt = tryAllocate(node);
+            if (failedAt == 0) {
+                const std::size_t offset                  = i << curPower;
+                powers[offset >> minPower]                = static_cast<std::uint8_t>(curPower);
+                return pool.get() + offset;
+            }
+            // nothing below the taken node fits, jump to its right neighbour
+            const std::size_t depth = power(failedAt) - curPower;
+            skip                    = ((failedAt + 1) << depth) - node;
+        }
+        // the jump stops at the end of the level, where the search wraps around
+        skip = std::min(skip, (i < start ? start : count) - i);
+        scanned += skip;
+        i = (i + skip) % count;
+    }
+    throw std::bad_alloc{};
+}
+
+void LockFreePoolAllocator::deallocate(const void* ptr) {
+    const auto offset       = static_cast<std::size_t>(static_cast<const std::byte*>(ptr) - pool.get());
+    const std::size_t power = powers[offset >> minPower];
+    const std::size_t node  = (static_cast<std::size_t>(1) << (maxPower - power)) + (offset >> power);
+    release(node, maxPower);
+}
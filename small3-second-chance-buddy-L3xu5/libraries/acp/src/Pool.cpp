@@ -1,92 +1,156 @@
 #include "acp/Pool.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <cstdlib>
 
-std::size_t evalCurPower(std::size_t sz) {
+namespace {
+
+std::size_t evalCurPower(const std::size_t sz) {
     std::size_t curPower = 0;
-    while (sz > 1 << curPower) {
+    while (sz > (static_cast<std::size_t>(1) << curPower)) {
         curPower++;
     }
     return curPower;
 }
 
-void PoolAllocator::eraseFromFreeNodes(PoolAllocator::Node* node) {
-    freeNodes[node->power].erase(node);
-    if (freeNodes[node->power].empty())
-        freeNodes.erase(node->power);
+bool test(const std::vector<std::uint64_t>& bits, const std::size_t i) { return (bits[i / 64] >> (i % 64)) & 1; }
+
+void set(std::vector<std::uint64_t>& bits, const std::size_t i) {
+    bits[i / 64] |= static_cast<std::uint64_t>(1) << (i % 64);
+}
+
+void reset(std::vector<std::uint64_t>& bits, const std::size_t i) {
+    bits[i / 64] &= ~(static_cast<std::uint64_t>(1) << (i % 64));
 }
 
-PoolAllocator::Node::Node(void* addr, PoolAllocator::Node* twin, std::size_t power, bool used)
-    : addr(addr), twin(twin), power(power), used(used) {}
+}  // namespace
 
 PoolAllocator::PoolAllocator(const std::size_t minPower, const std::size_t maxPower)
-    : minPower(minPower)
-     {
-    void* addr = std::malloc(1 << maxPower);
-    pool = {{addr, Node(addr, nullptr, maxPower, false)}};
-    freeNodes = {{maxPower, {&(pool.begin()->second)}}};
+    : PoolAllocator(minPower, maxPower, std::malloc(static_cast<std::size_t>(1) << std::max(minPower, maxPower)),
+                    true) {}
+
+PoolAllocator::PoolAllocator(const std::size_t minPower, const std::size_t maxPower, void* memory)
+    : PoolAllocator(minPower, maxPower, memory, false) {}
+
+PoolAllocator::PoolAllocator(const std::size_t minPower, const std::size_t maxPower, void* memory, const bool owned)
+    : minPower(minPower),
+      maxPower(std::max(minPower, maxPower)),
+      pool(static_cast<std::byte*>(memory)),
+      ownedPool(owned ? pool : nullptr),
+      heads(this->maxPower - minPower + 1, npos) {
+    if (pool == nullptr)
+        throw std::bad_alloc{};
+    // the tree has 2 ^ (levels) - 1 nodes, the root being node 0
+    const std::size_t nodes = (static_cast<std::size_t>(2) << (this->maxPower - minPower)) - 1;
+    splitBits.assign((nodes + 63) / 64, 0);
+    freeBits.assign((nodes + 63) / 64, 0);
+    if ((static_cast<std::size_t>(1) << minPower) < sizeof(Link))
+        sideLinks.resize(static_cast<std::size_t>(1) << (this->maxPower - minPower));
+    push(0, this->maxPower);
 }
 
-PoolAllocator::~PoolAllocator() {
-    std::free(const_cast<void*>(pool.begin()->first));
+// blocks of order power are numbered from 2 ^ (maxPower - power) - 1 on, left to right
+std::size_t PoolAllocator::node(const std::size_t offset, const std::size_t power) const {
+    return (static_cast<std::size_t>(1) << (maxPower - power)) - 1 + (offset >> power);
 }
 
-void* PoolAllocator::allocate(std::size_t const sz) {
-    std::size_t curPower = evalCurPower(sz);
-    curPower             = std::max(minPower, curPower);
-    auto availableNodes  = freeNodes.lower_bound(curPower);
-    if (availableNodes == freeNodes.end())
-        throw std::bad_alloc{};
-    auto toSplit           = *availableNodes->second.begin();
-    void* addr             = toSplit->addr;
-    std::size_t startPower = toSplit->power;
-    while (toSplit->power > curPower) {
-        toSplit->power--;
-        void* splitterAddr = static_cast<std::byte*>(addr) + (1 << toSplit->power);
-        pool.emplace(splitterAddr, Node(splitterAddr, toSplit, toSplit->power, false));
-        Node* splitter = &pool.find(splitterAddr)->second;
-        if (!freeNodes.contains(toSplit->power)) {
-            freeNodes.insert({toSplit->power, {splitter}});
-        } else {
-            freeNodes[toSplit->power].insert(splitter);
+PoolAllocator::Link& PoolAllocator::link(const std::size_t offset) {
+    if (!sideLinks.empty())
+        return sideLinks[offset >> minPower];
+    return *std::launder(reinterpret_cast<Link*>(pool + offset));
+}
+
+void PoolAllocator::push(const std::size_t offset, const std::size_t power) {
+    std::size_t& head = heads[power - minPower];
+    if (sideLinks.empty())
+        new (pool + offset) Link{npos, head};
+    else
+        link(offset) = Link{npos, head};
+    if (head != npos)
+        link(head).prev = offset;
+    head = offset;
+    set(freeBits, node(offset, power));
+}
+
+void PoolAllocator::remove(const std::size_t offset, const std::size_t power) {
+    Link& removed = link(offset);
+    if (removed.prev != npos)
+        link(removed.prev).next = removed.next;
+    else
+        heads[power - minPower] = removed.next;
+    if (removed.next != npos)
+        link(removed.next).prev = removed.prev;
+    reset(freeBits, node(offset, power));
+}
+
+std::size_t PoolAllocator::blockPower(const std::size_t sz) const { return std::max(minPower, evalCurPower(sz)); }
+
+std::size_t PoolAllocator::blockIndex(const void* ptr) const {
+    return static_cast<std::size_t>(static_cast<const std::byte*>(ptr) - pool) >> minPower;
+}
+
+// a free node n is a block of order maxPower - log2(n + 1)
+std::size_t PoolAllocator::freeBytes() const {
+    std::size_t total = 0;
+    for (std::size_t word = 0; word < freeBits.size(); ++word) {
+        for (std::uint64_t bits = freeBits[word]; bits != 0; bits &= bits - 1) {
+            const std::size_t n     = word * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+            const std::size_t depth = static_cast<std::size_t>(std::bit_width(n + 1)) - 1;
+            total += static_cast<std::size_t>(1) << (maxPower - depth);
         }
     }
-    toSplit->used = true;
-    pool.emplace(addr, *toSplit);
-    freeNodes[startPower].erase(toSplit);
-    if (freeNodes[startPower].empty())
-        freeNodes.erase(startPower);
-    return addr;
+    return total;
+}
+
+std::size_t PoolAllocator::largestFreeBlock() const {
+    for (std::size_t power = maxPower + 1; power-- > minPower;) {
+        if (heads[power - minPower] != npos)
+            return static_cast<std::size_t>(1) << power;
+    }
+    return 0;
+}
+
+void* PoolAllocator::allocate(std::size_t const sz) {
+    if (void* ptr = tryAllocate(sz))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void* PoolAllocator::tryAllocate(std::size_t const sz) noexcept {
+    const std::size_t curPower = blockPower(sz);
+    std::size_t power          = curPower;
+    while (power <= maxPower && heads[power - minPower] == npos) {
+        power++;
+    }
+    if (power > maxPower)
+        return nullptr;
+    const std::size_t offset = heads[power - minPower];
+    remove(offset, power);
+    // the first half is kept on every split, the second one becomes free
+    while (power > curPower) {
+        set(splitBits, node(offset, power));
+        power--;
+        push(offset + (static_cast<std::size_t>(1) << power), power);
+    }
+    return pool + offset;
 }
 
 void PoolAllocator::deallocate(void const* ptr) {
-    auto node = pool.find(ptr);
-    while (true) {
-        auto next = std::next(node);
-        eraseFromFreeNodes(&node->second);
-        if (next != pool.end() && next->second.twin == node->second && !next->second.used &&
-            node->second->power == next->second->power) {
-            eraseFromFreeNodes(next->second);
-            node->second->power++;
-            delete next->second;
-            pool.erase(next);
-        } else if (node != pool.begin()) {
-            auto prev = std::prev(node);
-            if (node->second->twin == prev->second && !prev->second->used &&
-                node->second->power == prev->second->power) {
-                eraseFromFreeNodes(prev->second);
-                prev->second->power++;
-                delete node->second;
-                pool.erase(node);
-                node = prev;
-            } else
-                break;
-        } else
+    std::size_t offset = static_cast<std::size_t>(static_cast<const std::byte*>(ptr) - pool);
+    // the allocated block is the first node on the way down which is not split
+    std::size_t power = maxPower;
+    while (power > minPower && test(splitBits, node(offset, power))) {
+        power--;
+    }
+    while (power < maxPower) {
+        const std::size_t buddy = offset ^ (static_cast<std::size_t>(1) << power);
+        if (!test(freeBits, node(buddy, power)))
             break;
+        remove(buddy, power);
+        offset = std::min(offset, buddy);
+        power++;
+        reset(splitBits, node(offset, power));
     }
-    node->second->used = false;
-    if (freeNodes.contains(node->second->power))
-        freeNodes[node->second->power].insert(node->second);
-    else
-        freeNodes[node->second->power] = {node->second};
+    push(offset, power);
 }
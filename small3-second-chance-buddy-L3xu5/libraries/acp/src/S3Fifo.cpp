@@ -0,0 +1,87 @@
+#include "acp/S3Fifo.hpp"
+
+#include <algorithm>
+#include <bit>
+
+S3Fifo::S3Fifo(const std::size_t capacity)
+    : ghosts(std::max<std::size_t>(1, capacity)), ghostCells(std::bit_ceil(4 * ghosts.size())) {
+    nodes.reserve(capacity);
+}
+
+void S3Fifo::push(Fifo& fifo, const std::size_t slot) {
+    nodes[slot].next = npos;
+    if (fifo.newest != npos) {
+        nodes[fifo.newest].next = slot;
+    } else {
+        fifo.oldest = slot;
+    }
+    fifo.newest = slot;
+    ++fifo.size;
+}
+
+std::size_t S3Fifo::pop(Fifo& fifo) {
+    const std::size_t slot = fifo.oldest;
+    fifo.oldest            = nodes[slot].next;
+    if (fifo.oldest == npos) {
+        fifo.newest = npos;
+    }
+    --fifo.size;
+    return slot;
+}
+
+std::size_t S3Fifo::cell(const std::size_t hash) const {
+    return static_cast<std::size_t>((hash * 0x9E3779B97F4A7C15ULL) >> 32) & (ghostCells.size() - 1);
+}
+
+bool S3Fifo::isGhost(const std::size_t hash) const { return ghostCells[cell(hash)] > 0; }
+
+// the ring remembers as many ghosts as there are elements in the cache
+void S3Fifo::addGhost(const std::size_t hash) {
+    if (ghosts.size() < nodes.size()) {
+        // the cache grew, older ghosts are dropped with the old ring
+        ghosts.assign(std::bit_ceil(nodes.size()), 0);
+        ghostCells.assign(4 * ghosts.size(), 0);
+        ghostNext  = 0;
+        ghostCount = 0;
+    }
+    if (ghostCount == ghosts.size()) {
+        --ghostCells[cell(ghosts[ghostNext])];
+    } else {
+        ++ghostCount;
+    }
+    ghosts[ghostNext] = hash;
+    ++ghostCells[cell(hash)];
+    ghostNext = (ghostNext + 1) % ghosts.size();
+}
+
+void S3Fifo::insert(const std::size_t slot, const std::size_t hash) {
+    if (slot >= nodes.size()) {
+        nodes.resize(slot + 1);
+    }
+    nodes[slot].hash = hash;
+    nodes[slot].freq = 0;
+    push(isGhost(hash) ? main : small, slot);
+}
+
+std::size_t S3Fifo::evict() {
+    while (true) {
+        const std::size_t smallTarget = std::max<std::size_t>(1, (small.size + main.size) / 10);
+        if (small.size > 0 && (small.size >= smallTarget || main.size == 0)) {
+            const std::size_t slot = pop(small);
+            if (nodes[slot].freq > 1) {
+                nodes[slot].freq = 0;
+                push(main, slot);
+                continue;
+            }
+            addGhost(nodes[slot].hash);
+            return slot;
+        }
+        const std::size_t slot = pop(main);
+        if (nodes[slot].freq > 0) {
+            --nodes[slot].freq;
+            push(main, slot);
+            continue;
+        }
+        return slot;
+    }
+}
@@ -0,0 +1,37 @@
+#include "acp/SecondChance.hpp"
+
+#include <bit>
+
+SecondChance::SecondChance(const std::size_t capacity) {
+    referenced.reserve((capacity + 63) / 64);
+    resident.reserve((capacity + 63) / 64);
+}
+
+void SecondChance::insert(const std::size_t slot, std::size_t) {
+    if (slot >= slots) {
+        slots = slot + 1;
+        referenced.resize((slots + 63) / 64);
+        resident.resize((slots + 63) / 64);
+    }
+    const std::uint64_t mark = std::uint64_t{1} << (slot % 64);
+    referenced[slot / 64] &= ~mark;
+    resident[slot / 64] |= mark;
+}
+
+// clears the bits from the hand on a word at a time up to the first resident slot not referenced
+std::size_t SecondChance::evict() {
+    while (true) {
+        const std::size_t word    = hand / 64;
+        const std::uint64_t ahead = resident[word] & (~std::uint64_t{0} << (hand % 64));
+        if (const std::uint64_t cold = ahead & ~referenced[word]) {
+            const auto bit           = static_cast<std::size_t>(std::countr_zero(cold));
+            const std::size_t victim = word * 64 + bit;
+            referenced[word] &= ~(ahead & ((std::uint64_t{1} << bit) - 1));
+            resident[word] &= ~(std::uint64_t{1} << bit);
+            hand = victim + 1 == slots ? 0 : victim + 1;
+            return victim;
+        }
+        referenced[word] &= ~ahead;
+        hand = (word + 1) * 64 >= slots ? 0 : (word + 1) * 64;
+    }
+}
@@ -0,0 +1,156 @@
+#include "acp/TinyLfu.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace {
+
+constexpr std::size_t rows = 4;
+
+constexpr std::array<std::uint64_t, rows> seeds = {0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL,
+                                                   0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL};
+
+}  // namespace
+
+WTinyLfu::Sketch::Sketch(const std::size_t width)
+    : rowWidth(std::bit_ceil(std::max<std::size_t>(16, width))), counters(rows * rowWidth / 2) {}
+
+std::size_t WTinyLfu::Sketch::cell(const std::size_t hash, const std::size_t row) const {
+    const std::uint64_t mixed = (static_cast<std::uint64_t>(hash) + row) * seeds[row];
+    return row * rowWidth + (static_cast<std::size_t>(mixed >> 32) & (rowWidth - 1));
+}
+
+unsigned WTinyLfu::Sketch::get(const std::size_t cell) const {
+    const std::uint8_t pair = counters[cell / 2];
+    return cell % 2 ? pair >> 4 : pair & 0x0F;
+}
+
+void WTinyLfu::Sketch::add(const std::size_t hash) {
+    for (std::size_t row = 0; row < rows; ++row) {
+        const std::size_t at = cell(hash, row);
+        if (get(at) < 15) {
+            counters[at / 2] += at % 2 ? 0x10 : 0x01;
+        }
+    }
+    if (++additions == 10 * rowWidth) {
+        for (auto& pair : counters) {
+            pair = static_cast<std::uint8_t>((pair >> 1) & 0x77);
+        }
+        additions /= 2;
+    }
+}
+
+unsigned WTinyLfu::Sketch::estimate(const std::size_t hash) const {
+    unsigned least = 15;
+    for (std::size_t row = 0; row < rows; ++row) {
+        least = std::min(least, get(cell(hash, row)));
+    }
+    return least;
+}
+
+WTinyLfu::WTinyLfu(const std::size_t capacity) : sketch(capacity), capacity(std::max<std::size_t>(1, capacity)) {
+    nodes.reserve(capacity);
+}
+
+std::size_t WTinyLfu::windowTarget() const { return std::max<std::size_t>(1, capacity / 100); }
+
+WTinyLfu::Lru& WTinyLfu::lru(const Segment segment) {
+    switch (segment) {
+        case Segment::window:
+            return window;
+        case Segment::probation:
+            return probation;
+        default:
+            return protect;
+    }
+}
+
+void WTinyLfu::push(const Segment segment, const std::size_t slot) {
+    Lru& list           = lru(segment);
+    nodes[slot].segment = segment;
+    nodes[slot].prev    = npos;
+    nodes[slot].next    = list.newest;
+    if (list.newest != npos) {
+        nodes[list.newest].prev = slot;
+    } else {
+        list.oldest = slot;
+    }
+    list.newest = slot;
+    ++list.size;
+}
+
+void WTinyLfu::remove(const std::size_t slot) {
+    Lru& list = lru(nodes[slot].segment);
+    if (nodes[slot].prev != npos) {
+        nodes[nodes[slot].prev].next = nodes[slot].next;
+    } else {
+        list.newest = nodes[slot].next;
+    }
+    if (nodes[slot].next != npos) {
+        nodes[nodes[slot].next].prev = nodes[slot].prev;
+    } else {
+        list.oldest = nodes[slot].prev;
+    }
+    --list.size;
+}
+
+void WTinyLfu::insert(const std::size_t slot, const std::size_t hash) {
+    if (slot >= nodes.size()) {
+        nodes.resize(slot + 1);
+    }
+    capacity = std::max(capacity, window.size + probation.size + protect.size + 1);
+    if (capacity > sketch.width()) {
+        // the cache outgrew the sketch, popularity is counted anew
+        sketch = Sketch(2 * capacity);
+    }
+    sketch.add(hash);
+    nodes[slot].hash = hash;
+    push(Segment::window, slot);
+    // while the cache fills up nothing is evicted and the window overflows into probation
+    while (window.size > windowTarget()) {
+        const std::size_t moved = window.oldest;
+        remove(moved);
+        push(Segment::probation, moved);
+    }
+}
+
+void WTinyLfu::touch(const std::size_t slot) {
+    sketch.add(nodes[slot].hash);
+    const Segment segment = nodes[slot].segment;
+    remove(slot);
+    if (segment == Segment::window) {
+        push(Segment::window, slot);
+        return;
+    }
+    push(Segment::protect, slot);
+    // the protected segment keeps about 80% of the main part, its oldest go back to probation
+    const std::size_t protectTarget = (capacity - std::min(capacity, windowTarget())) * 4 / 5;
+    while (protect.size > std::max<std::size_t>(1, protectTarget)) {
+        const std::size_t demoted = protect.oldest;
+        remove(demoted);
+        push(Segment::probation, demoted);
+    }
+}
+
+std::size_t WTinyLfu::evict() {
+    const bool mainEmpty = probation.size + protect.size == 0;
+    if (window.size == 0 || (window.size < windowTarget() && !mainEmpty)) {
+        // the window is small enough, the main part gives its oldest
+        const std::size_t victim = probation.size > 0 ? probation.oldest : protect.oldest;
+        remove(victim);
+        return victim;
+    }
+    const std::size_t candidate = window.oldest;
+    remove(candidate);
+    if (mainEmpty) {
+        return candidate;
+    }
+    const std::size_t victim = probation.size > 0 ? probation.oldest : protect.oldest;
+    if (sketch.estimate(nodes[candidate].hash) > sketch.estimate(nodes[victim].hash)) {
+        remove(victim);
+        push(Segment::probation, candidate);
+        return victim;
+    }
+    return candidate;
+}
@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <iomanip>
 #include <memory>
 #include <new>
@@ -8,6 +9,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <unordered_map>
@@ -20,6 +22,9 @@
 #include "jemalloc/jemalloc.h"
 #endif
 
+#include "acp/ArenaPool.hpp"
+#include "acp/ConcurrentPool.hpp"
+#include "acp/LockFreePool.hpp"
 #include "acp/Pool.hpp"
 
 namespace {
@@ -152,6 +157,24 @@ TEST(BasicAllocatorTest, allocate_smallest) {
     alloc.deallocate(fourth);
 }
 
+TEST(BasicAllocatorTest, free_statistics) {
+    PoolAllocator alloc(4, 8);
+    EXPECT_EQ(256, alloc.freeBytes());
+    EXPECT_EQ(256, alloc.largestFreeBlock());
+    void *first  = alloc.allocate(16);
+    void *second = alloc.allocate(64);
+    EXPECT_EQ(176, alloc.freeBytes());
+    EXPECT_EQ(128, alloc.largestFreeBlock());
+    void *third = alloc.allocate(128);
+    EXPECT_EQ(48, alloc.freeBytes());
+    EXPECT_EQ(32, alloc.largestFreeBlock());
+    alloc.deallocate(first);
+    alloc.deallocate(second);
+    alloc.deallocate(third);
+    EXPECT_EQ(256, alloc.freeBytes());
+    EXPECT_EQ(256, alloc.largestFreeBlock());
+}
+
 TYPED_TEST(AllocatorTest, single_dummy) {
     auto ptr     = this->create_dummy();
     ptr->data[0] = 112;
@@ -427,6 +450,137 @@ TYPED_TEST(AllocatorTest, complex_fragmentation) {
     }
 }
 
+namespace {
+
+template <class Alloc>
+struct ConcurrentAllocatorTest: ::testing::Test {};
+
+using ConcurrentTypes = ::testing::Types<ConcurrentPoolAllocator, LockFreePoolAllocator>;
+TYPED_TEST_SUITE(ConcurrentAllocatorTest, ConcurrentTypes);
+
+}  // anonymous namespace
+
+TYPED_TEST(ConcurrentAllocatorTest, full_single_thread) {
+    TypeParam alloc(4, 10);
+    std::vector<void *> ptrs;
+    for (std::size_t i = 0; i < 64; ++i) {
+        ptrs.push_back(alloc.allocate(16));
+    }
+    EXPECT_THROW(alloc.allocate(1), std::bad_alloc);
+    for (auto ptr : ptrs) {
+        alloc.deallocate(ptr);
+    }
+    // freed blocks merge back, including the ones cached by this thread
+    void *whole = alloc.allocate(1024);
+    EXPECT_THROW(alloc.allocate(1), std::bad_alloc);
+    alloc.deallocate(whole);
+}
+
+TYPED_TEST(ConcurrentAllocatorTest, threads_do_not_overlap) {
+    TypeParam alloc(4, 20);
+    const std::size_t thread_count = 8;
+    const std::size_t rounds       = 20000;
+    const std::size_t live         = 64;
+    std::vector<std::size_t> failures(thread_count, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            struct Slot {
+                unsigned char *ptr = nullptr;
+                std::size_t size   = 0;
+                unsigned char mark = 0;
+            };
+            const auto intact = [](const Slot &slot) {
+                return std::all_of(slot.ptr, slot.ptr + slot.size, [&](unsigned char c) { return c == slot.mark; });
+            };
+            std::vector<Slot> slots(live);
+            std::size_t seed = t + 1;
+            for (std::size_t i = 0; i < rounds; ++i) {
+                seed        = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                Slot &slot  = slots[(seed >> 33) % live];
+                if (slot.ptr) {
+                    failures[t] += !intact(slot);
+                    alloc.deallocate(slot.ptr);
+                }
+                // sizes from 1 to 256 bytes, every block with its own fill byte
+                slot.size = 1 + (seed >> 20) % 256;
+                slot.mark = static_cast<unsigned char>(t * 31 + i);
+                slot.ptr  = static_cast<unsigned char *>(alloc.allocate(slot.size));
+                std::fill(slot.ptr, slot.ptr + slot.size, slot.mark);
+            }
+            for (const Slot &slot : slots) {
+                if (slot.ptr) {
+                    failures[t] += !intact(slot);
+                    alloc.deallocate(slot.ptr);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        EXPECT_EQ(0, failures[t]) << "Overwritten blocks of thread " << t;
+    }
+    // everything merged back, nothing is left in the magazines of finished threads
+    EXPECT_NO_THROW(alloc.deallocate(alloc.allocate(1 << 20)));
+}
+
+TEST(ConcurrentPoolTest, switches_between_allocators) {
+    std::optional<ConcurrentPoolAllocator> first(std::in_place, 4, 10);
+    ConcurrentPoolAllocator second(4, 10);
+    for (std::size_t i = 0; i < 100; ++i) {
+        first->deallocate(first->allocate(16));
+        second.deallocate(second.allocate(16));
+    }
+    // a new allocator, possibly at the address of the old one, starts with empty magazines of its own
+    first.reset();
+    first.emplace(4, 10);
+    std::vector<void *> ptrs;
+    for (std::size_t i = 0; i < 64; ++i) {
+        ptrs.push_back(first->allocate(16));
+        std::memset(ptrs.back(), 0x5a, 16);
+    }
+    EXPECT_THROW(first->allocate(1), std::bad_alloc);
+    for (auto ptr : ptrs) {
+        first->deallocate(ptr);
+    }
+    EXPECT_NO_THROW(first->deallocate(first->allocate(1024)));
+    EXPECT_NO_THROW(second.deallocate(second.allocate(1024)));
+}
+
+TEST(ArenaAllocatorTest, grows_and_shrinks) {
+    ArenaPoolAllocator alloc(4, 12, 0);
+    std::vector<void *> ptrs;
+    for (std::size_t i = 0; i < 4096 / 16; ++i) {
+        ptrs.push_back(alloc.allocate(16));
+    }
+    EXPECT_EQ(1, alloc.arenaCount());
+    ptrs.push_back(alloc.allocate(16));
+    EXPECT_EQ(2, alloc.arenaCount());
+    EXPECT_THROW(alloc.allocate(4097), std::bad_alloc);
+    for (auto ptr : ptrs) {
+        static_cast<unsigned char *>(ptr)[15] = 0x5a;
+        alloc.deallocate(ptr);
+    }
+    EXPECT_EQ(0, alloc.arenaCount());
+}
+
+TEST(ArenaAllocatorTest, keeps_spare_arenas) {
+    ArenaPoolAllocator alloc(0, 2, 1);
+    std::vector<void *> ptrs;
+    for (std::size_t i = 0; i < 12; ++i) {
+        ptrs.push_back(alloc.allocate(1));
+    }
+    EXPECT_EQ(3, alloc.arenaCount());
+    for (auto ptr : ptrs) {
+        alloc.deallocate(ptr);
+    }
+    EXPECT_EQ(1, alloc.arenaCount());
+    EXPECT_NO_THROW(alloc.deallocate(alloc.allocate(4)));
+    EXPECT_EQ(1, alloc.arenaCount());
+}
+
 #ifdef JEMALLOC
 namespace {
 
@@ -1,10 +1,17 @@
 #include <algorithm>
 #include <iomanip>
+#include <numeric>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
 
 #include "acp/Allocator.hpp"
 #include "acp/Cache.hpp"
+#include "acp/ClockPro.hpp"
+#include "acp/S3Fifo.hpp"
+#include "acp/ShardedCache.hpp"
+#include "acp/TinyLfu.hpp"
 #include "gtest/gtest.h"
 
 namespace {
@@ -50,6 +57,20 @@ struct Point: WithIntKey {
     }
 };
 
+// std::hash, except that every hash of the failing key after the first throws,
+// so a get of it finds no element and then cannot index the new one
+struct FlakyHash {
+    static inline int failing = -1;
+    static inline int calls   = 0;
+
+    std::size_t operator()(const int key) const {
+        if (key == failing && ++calls > 1) {
+            throw std::runtime_error("flaky hash");
+        }
+        return std::hash<int>{}(key);
+    }
+};
+
 template <std::size_t size>
 using Size = std::integral_constant<std::size_t, size>;
 
@@ -302,6 +323,210 @@ TYPED_TEST(SecondChanceTest, add_full__then_revisit_half__then_add_half) {
     EXPECT_EQ(this->cache_size, this->cache.size());
 }
 
+TEST(SecondChanceLargeTest, evicts_unvisited_half) {
+    const std::size_t cache_size = 1 << 14;
+    const std::size_t min_power  = upper_bin_power(sizeof(Point));
+    Cache<int, WithIntKey, AllocatorWithPool> cache(cache_size, min_power, min_power + 15);
+    for (std::size_t i = 0; i < cache_size; ++i) {
+        cache.get<Point>(static_cast<int>(i)).marked = true;
+    }
+    for (std::size_t i = 0; i < cache_size; i += 2) {
+        cache.get<Point>(static_cast<int>(i));
+    }
+    for (std::size_t i = 0; i < cache_size / 2; ++i) {
+        EXPECT_FALSE(cache.get<Point>(-1 - static_cast<int>(i)).marked);
+    }
+    EXPECT_EQ(cache_size, cache.size());
+    for (std::size_t i = 0; i < cache_size; i += 2) {
+        EXPECT_TRUE(cache.get<Point>(static_cast<int>(i)).marked) << "Wrong item " << i;
+    }
+    EXPECT_FALSE(cache.get<Point>(1).marked);
+}
+
+TEST(SecondChanceLargeTest, hand_crosses_words) {
+    const std::size_t cache_size = 100;
+    const std::size_t min_power  = upper_bin_power(sizeof(Point));
+    Cache<int, WithIntKey, AllocatorWithPool> cache(cache_size, min_power, min_power + 7);
+    for (std::size_t i = 0; i < cache_size; ++i) {
+        cache.get<Point>(static_cast<int>(i)).marked = true;
+    }
+    for (std::size_t i = 0; i < cache_size; ++i) {
+        if (i != 70 && i != 99) {
+            cache.get<Point>(static_cast<int>(i));
+        }
+    }
+    EXPECT_FALSE(cache.get<Point>(1000).marked);
+    EXPECT_FALSE(cache.get<Point>(1001).marked);
+    // every other element got its second chance, the next miss takes the oldest again
+    EXPECT_FALSE(cache.get<Point>(1002).marked);
+    EXPECT_FALSE(cache.get<Point>(70).marked);
+    EXPECT_FALSE(cache.get<Point>(99).marked);
+    EXPECT_EQ(cache_size, cache.size());
+}
+
+template <class P>
+struct PolicyTest: ::testing::Test {
+    static constexpr std::size_t cache_size = 100;
+    static constexpr std::size_t min_power  = upper_bin_power(sizeof(Point));
+
+    Cache<int, WithIntKey, AllocatorWithPool, P> cache;
+
+    PolicyTest() : cache(cache_size, min_power, min_power + 7) {}
+
+    // marks the element, so the result tells whether it was a hit
+    bool hit(const int n) {
+        Point& p        = cache.template get<Point>(n);
+        const bool seen = p.marked;
+        p.marked        = true;
+        return seen;
+    }
+};
+
+using TestedPolicies = ::testing::Types<SecondChance, S3Fifo, ClockPro, WTinyLfu>;
+TYPED_TEST_SUITE(PolicyTest, TestedPolicies);
+
+TYPED_TEST(PolicyTest, random_keys) {
+    std::size_t seed = 1;
+    for (std::size_t i = 0; i < 20000; ++i) {
+        seed          = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const int key = static_cast<int>((seed >> 33) % 300);
+        const auto& p = this->cache.template get<Point>(key);
+        ASSERT_EQ(key, p.key);
+        ASSERT_EQ(Point::convert_data(key), p.data);
+        ASSERT_GE(this->cache_size, this->cache.size());
+    }
+    EXPECT_EQ(this->cache_size, this->cache.size());
+}
+
+TYPED_TEST(PolicyTest, hot_keys_survive_scan) {
+    const int hot_count = 50;
+    for (int round = 0; round < 3; ++round) {
+        for (int n = 0; n < hot_count; ++n) {
+            this->hit(n);
+        }
+    }
+    std::size_t hot_hits = 0;
+    const int scan_count = 1000;
+    for (int i = 0; i < scan_count; ++i) {
+        EXPECT_FALSE(this->hit(1000 + i));
+        hot_hits += this->hit(i % hot_count);
+    }
+    EXPECT_LT(0.9 * scan_count, hot_hits);
+    EXPECT_EQ(this->cache_size, this->cache.size());
+}
+
+TEST(ShardedCacheTest, exclusive_touch_policy) {
+    const std::size_t min_power = upper_bin_power(sizeof(Point));
+    ShardedCache<int, WithIntKey, AllocatorWithPool, WTinyLfu> cache(2, 10, min_power, min_power + 4);
+    for (int n = 0; n < 100; ++n) {
+        EXPECT_EQ(n % 20, cache.get<Point>(n % 20, [](const Point& p) { return p.key; }));
+    }
+    EXPECT_EQ(10, cache.size());
+}
+
+TEST(ByteBudgetTest, evicts_until_element_fits) {
+    const std::size_t point_block = std::size_t{1} << upper_bin_power(sizeof(Point));
+    using Big                     = StringT<4 * sizeof(Point)>;
+    const std::size_t big_block   = std::size_t{1} << upper_bin_power(sizeof(Big));
+    const std::size_t min_power   = upper_bin_power(sizeof(Point));
+    const std::size_t budget      = big_block + 2 * point_block;
+    Cache<int, WithIntKey, AllocatorWithPool> cache(ByteBudget{budget}, min_power, upper_bin_power(4 * budget));
+    const std::size_t points = budget / point_block;
+    for (std::size_t i = 0; i < points + 1; ++i) {
+        cache.get<Point>(static_cast<int>(i)).marked = true;
+    }
+    EXPECT_EQ(points, cache.size());
+    EXPECT_EQ(budget, cache.bytes());
+    // the big element takes the place of as many points as it needs
+    cache.get<Big>(1000);
+    EXPECT_EQ(3, cache.size());
+    EXPECT_EQ(budget, cache.bytes());
+    EXPECT_TRUE(cache.get<Point>(static_cast<int>(points)).marked);
+    EXPECT_FALSE(cache.get<Point>(0).marked);
+    EXPECT_GE(budget, cache.bytes());
+}
+
+TEST(ByteBudgetTest, bigger_than_budget_is_kept_alone) {
+    const std::size_t min_power = upper_bin_power(sizeof(Point));
+    const std::size_t budget    = std::size_t{4} << min_power;
+    Cache<int, WithIntKey, AllocatorWithPool> cache(ByteBudget{budget}, min_power, min_power + 6);
+    for (int n = 0; n < 4; ++n) {
+        cache.get<Point>(n);
+    }
+    EXPECT_EQ(4, cache.size());
+    EXPECT_EQ("1000", cache.get<StringT<8 * sizeof(Point)>>(1000).data);
+    EXPECT_EQ(1, cache.size());
+    cache.get<Point>(1);
+    EXPECT_EQ(1, cache.size());
+    EXPECT_EQ(budget / 4, cache.bytes());
+}
+
+TEST(ByteBudgetTest, evicts_while_pool_is_full) {
+    const std::size_t min_power = upper_bin_power(sizeof(Point));
+    // the budget would hold 16 points but the pool only 8
+    Cache<int, WithIntKey, AllocatorWithPool> cache(ByteBudget{std::size_t{16} << min_power}, min_power,
+                                                    min_power + 3);
+    for (int n = 0; n < 20; ++n) {
+        EXPECT_EQ(n, cache.get<Point>(n).key);
+        EXPECT_GE(8, cache.size());
+    }
+    EXPECT_EQ(8, cache.size());
+    EXPECT_EQ(std::size_t{8} << min_power, cache.bytes());
+}
+
+TEST(ByteBudgetTest, count_capacity_still_throws_when_pool_is_full) {
+    const std::size_t min_power = upper_bin_power(sizeof(Point));
+    Cache<int, WithIntKey, AllocatorWithPool> cache(16, min_power, min_power + 3);
+    for (int n = 0; n < 8; ++n) {
+        cache.get<Point>(n);
+    }
+    EXPECT_THROW(cache.get<Point>(8), std::bad_alloc);
+    EXPECT_EQ(8, cache.size());
+}
+
+TEST(CacheTest, failed_insert_frees_element) {
+    const std::size_t min_power = upper_bin_power(sizeof(Point));
+    // the pool holds 8 points, so a leaked one would leave no room for the last
+    Cache<int, WithIntKey, AllocatorWithPool, SecondChance, FlakyHash> cache(16, min_power, min_power + 3);
+    for (int n = 0; n < 7; ++n) {
+        cache.get<Point>(n);
+    }
+    FlakyHash::failing = 100;
+    EXPECT_THROW(cache.get<Point>(100), std::runtime_error);
+    FlakyHash::failing = -1;
+    EXPECT_EQ(7, cache.size());
+    EXPECT_EQ(7, cache.get<Point>(7).key);
+    EXPECT_EQ(8, cache.size());
+}
+
+TEST(ShardedCacheTest, threads_get_their_keys) {
+    const std::size_t thread_count = 8;
+    const std::size_t rounds       = 20000;
+    const std::size_t min_power    = upper_bin_power(sizeof(Point));
+    ShardedCache<int, WithIntKey, AllocatorWithPool> cache(4, 1000, min_power, min_power + 9);
+    EXPECT_EQ(4, cache.shard_count());
+    std::vector<std::size_t> failures(thread_count, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            std::size_t seed = t + 1;
+            for (std::size_t i = 0; i < rounds; ++i) {
+                seed          = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                const int key = static_cast<int>((seed >> 33) % 1500);
+                failures[t] += cache.get<Point>(key, [&](const Point& p) {
+                    return p.key != key || p.data != Point::convert_data(key);
+                });
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(0, std::accumulate(failures.begin(), failures.end(), std::size_t{0}));
+    EXPECT_GE(1000, cache.size());
+    EXPECT_LT(900, cache.size());
+}
+
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
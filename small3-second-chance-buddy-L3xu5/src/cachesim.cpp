@@ -0,0 +1,445 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "acp/Cache.hpp"
+#include "acp/ClockPro.hpp"
+#include "acp/Pool.hpp"
+#include "acp/S3Fifo.hpp"
+#include "acp/SecondChance.hpp"
+#include "acp/TinyLfu.hpp"
+
+// replays a key trace, read from a file or generated, through Cache with every policy and size asked
+// for, and prints hit ratio, time per request and how fragmented the buddy pool ends up
+namespace {
+
+const char usage[] =
+    "usage: cachesim (--trace FILE [--format text|lirs|arc] | --zipf KEYS,ALPHA,REQUESTS [--scan FRACTION,LENGTH])\n"
+    "                [--sizes N,...] [--bytes] [--policy second-chance|s3-fifo|clock-pro|w-tinylfu]... [--seed N]\n"
+    "  text: a key per non-empty line; lirs: a block number per line; arc: \"first count ...\" per line, count blocks\n"
+    "  --scan: that fraction of requests comes in runs of LENGTH keys never seen before\n"
+    "  --bytes: sizes are byte budgets counting the pool blocks of the elements instead of element counts\n"
+    "  without --sizes the cache is 1, 2, 5, 10, 20 and 50% of the distinct keys, in average blocks with --bytes\n";
+
+constexpr unsigned upper_bin_power(const std::size_t n) {
+    unsigned i = 0;
+    while ((1UL << i) < n) {
+        ++i;
+    }
+    return i;
+}
+
+std::uint64_t mix(const std::uint64_t key) { return key * 0x9E3779B97F4A7C15ULL; }
+
+struct Keyed {
+    const std::uint64_t key;
+    // sizeof the whole element, for the allocator statistics
+    const std::uint32_t bytes;
+
+    Keyed(const std::uint64_t key_, const std::uint32_t bytes_) : key(key_), bytes(bytes_) {}
+
+    bool operator==(const std::uint64_t other_key) const { return key == other_key; }
+};
+
+template <std::size_t Payload>
+struct Entry: Keyed {
+    char payload[Payload];
+
+    Entry(const std::uint64_t key_) : Keyed(key_, sizeof(Entry)) {}
+};
+
+// largest of the Entry sizes get_entry picks from, and the average of their blocks
+constexpr std::size_t max_entry     = sizeof(Entry<200>);
+constexpr std::size_t average_block = 120;
+
+// buddy pool counting the bytes asked for and the bytes of the blocks handed out
+class MeasuredAllocator {
+public:
+    MeasuredAllocator(const std::size_t min_power, const std::size_t max_power) : pool(min_power, max_power) {}
+
+    std::size_t blockSize(const std::size_t sz) const { return static_cast<std::size_t>(1) << pool.blockPower(sz); }
+
+    template <class T, class... Args>
+    T *create(Args &&...args) {
+        auto *ptr = pool.allocate(sizeof(T));
+        requested += sizeof(T);
+        allocated += static_cast<std::size_t>(1) << pool.blockPower(sizeof(T));
+        return new (ptr) T(std::forward<Args>(args)...);
+    }
+
+    template <class T>
+    void destroy(void *ptr) {
+        const std::size_t bytes = static_cast<T *>(ptr)->bytes;
+        static_cast<T *>(ptr)->~T();
+        pool.deallocate(ptr);
+        requested -= bytes;
+        allocated -= static_cast<std::size_t>(1) << pool.blockPower(bytes);
+    }
+
+    // share of the live blocks' bytes lost to rounding up to a power of two
+    double internal_fragmentation() const {
+        return allocated == 0 ? 0.0 : 1.0 - static_cast<double>(requested) / static_cast<double>(allocated);
+    }
+
+    // share of the free bytes not in the largest free block
+    double external_fragmentation() const {
+        const std::size_t free = pool.freeBytes();
+        return free == 0 ? 0.0 : 1.0 - static_cast<double>(pool.largestFreeBlock()) / static_cast<double>(free);
+    }
+
+private:
+    PoolAllocator pool;
+    std::size_t requested = 0;
+    std::size_t allocated = 0;
+};
+
+// read-only mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot stat " + path);
+        }
+        length = static_cast<std::size_t>(st.st_size);
+        if (length > 0) {
+            data = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("cannot map " + path);
+        }
+        if (length > 0) {
+            ::madvise(data, length, MADV_SEQUENTIAL);
+        }
+    }
+
+    MappedFile(const MappedFile &)            = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    std::string_view contents() const { return {static_cast<const char *>(data), length}; }
+
+    ~MappedFile() {
+        if (length > 0) {
+            ::munmap(data, length);
+        }
+    }
+
+private:
+    void *data         = nullptr;
+    std::size_t length = 0;
+};
+
+template <class F>
+void for_each_line(std::string_view text, F &&f) {
+    while (!text.empty()) {
+        const std::size_t end = std::min(text.find('\n'), text.size());
+        std::string_view line = text.substr(0, end);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        f(line);
+        text.remove_prefix(std::min(end + 1, text.size()));
+    }
+}
+
+// leading number of s, false if s does not start with one; s is left past it and the spaces after
+bool parse_number(std::string_view &s, std::uint64_t &value) {
+    const auto [end, error] = std::from_chars(s.data(), s.data() + s.size(), value);
+    if (error != std::errc{}) {
+        return false;
+    }
+    s.remove_prefix(static_cast<std::size_t>(end - s.data()));
+    s.remove_prefix(std::min(s.find_first_not_of(" \t"), s.size()));
+    return true;
+}
+
+// lines that are not numbers, like the '*' ending LIRS traces, are skipped
+std::vector<std::uint64_t> read_trace(const std::string &path, const std::string &format) {
+    const MappedFile file(path);
+    std::vector<std::uint64_t> keys;
+    if (format == "text") {
+        // keys are numbered in order of first appearance, the views point into the mapping; blank lines are no keys
+        std::unordered_map<std::string_view, std::uint64_t> ids;
+        for_each_line(file.contents(), [&](const std::string_view line) {
+            if (!line.empty()) {
+                keys.push_back(ids.try_emplace(line, ids.size()).first->second);
+            }
+        });
+    } else if (format == "lirs") {
+        for_each_line(file.contents(), [&](std::string_view line) {
+            if (std::uint64_t block; parse_number(line, block)) {
+                keys.push_back(block);
+            }
+        });
+    } else if (format == "arc") {
+        for_each_line(file.contents(), [&](std::string_view line) {
+            std::uint64_t first;
+            std::uint64_t count;
+            if (parse_number(line, first) && parse_number(line, count)) {
+                for (std::uint64_t i = 0; i < count; ++i) {
+                    keys.push_back(first + i);
+                }
+            }
+        });
+    } else {
+        throw std::runtime_error("unknown trace format " + format);
+    }
+    return keys;
+}
+
+struct Synthetic {
+    std::size_t keys     = 0;
+    double alpha         = 0;
+    std::size_t requests = 0;
+    double scan_fraction = 0;
+    std::size_t scan_run = 0;
+};
+
+// zipf over keys 0..keys-1, interrupted by runs of keys from keys up that are each requested once
+std::vector<std::uint64_t> generate_trace(const Synthetic &spec, const std::uint64_t seed) {
+    std::vector<double> cdf(spec.keys);
+    double sum = 0;
+    for (std::size_t rank = 0; rank < spec.keys; ++rank) {
+        sum += 1.0 / std::pow(static_cast<double>(rank + 1), spec.alpha);
+        cdf[rank] = sum;
+    }
+    std::mt19937_64 random(seed);
+    std::uniform_real_distribution<double> uniform(0.0, sum);
+    // runs start with a probability making their requests the asked share
+    const double run_start =
+        spec.scan_run == 0 || spec.scan_fraction >= 1
+            ? spec.scan_fraction
+            : spec.scan_fraction / (static_cast<double>(spec.scan_run) * (1 - spec.scan_fraction) + spec.scan_fraction);
+    std::bernoulli_distribution start_scan(std::clamp(run_start, 0.0, 1.0));
+    std::vector<std::uint64_t> keys;
+    keys.reserve(spec.requests);
+    std::uint64_t next_scanned = spec.keys;
+    while (keys.size() < spec.requests) {
+        if (spec.scan_run > 0 && start_scan(random)) {
+            for (std::size_t i = 0; i < spec.scan_run && keys.size() < spec.requests; ++i) {
+                keys.push_back(next_scanned++);
+            }
+            continue;
+        }
+        const auto rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(random)) - cdf.begin();
+        keys.push_back(static_cast<std::uint64_t>(std::min<std::ptrdiff_t>(rank, spec.keys - 1)));
+    }
+    return keys;
+}
+
+struct Result {
+    std::size_t hits     = 0;
+    std::size_t failures = 0;
+    double ns_per_op     = 0;
+    double internal      = 0;
+    double external      = 0;
+};
+
+template <class C>
+void get_entry(C &cache, const std::uint64_t key) {
+    // element sizes of 16 to 208 bytes, spread evenly over the keys
+    switch (mix(key) >> 62) {
+        case 0:
+            cache.template get<Entry<4>>(key);
+            break;
+        case 1:
+            cache.template get<Entry<40>>(key);
+            break;
+        case 2:
+            cache.template get<Entry<100>>(key);
+            break;
+        default:
+            cache.template get<Entry<200>>(key);
+            break;
+    }
+}
+
+template <class Policy>
+Result replay(const std::vector<std::uint64_t> &keys, const std::size_t cache_size, const bool byte_budget) {
+    using TestedCache = Cache<std::uint64_t, Keyed, MeasuredAllocator, Policy>;
+    // twice the bytes the cache may hold, so that misses rarely find the pool too fragmented
+    const std::size_t room      = byte_budget ? cache_size : (1UL << upper_bin_power(max_entry)) * cache_size;
+    const std::size_t min_power = upper_bin_power(sizeof(Entry<4>));
+    const std::size_t max_power = upper_bin_power(room * 2);
+    TestedCache cache           = byte_budget ? TestedCache(ByteBudget{cache_size}, min_power, max_power)
+                                              : TestedCache(cache_size, min_power, max_power);
+    Result result;
+    const auto start = std::chrono::steady_clock::now();
+    for (const std::uint64_t key : keys) {
+        if (cache.find(key) != nullptr) {
+            ++result.hits;
+            continue;
+        }
+        try {
+            get_entry(cache, key);
+        } catch (const std::bad_alloc &) {
+            ++result.failures;
+        }
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    result.ns_per_op = keys.empty() ? 0.0 : elapsed.count() / static_cast<double>(keys.size());
+    result.internal = cache.allocator().internal_fragmentation();
+    result.external = cache.allocator().external_fragmentation();
+    return result;
+}
+
+const std::vector<std::string> policy_names = {"second-chance", "s3-fifo", "clock-pro", "w-tinylfu"};
+
+Result replay(const std::string &policy, const std::vector<std::uint64_t> &keys, const std::size_t cache_size,
+              const bool byte_budget) {
+    if (policy == "second-chance") {
+        return replay<SecondChance>(keys, cache_size, byte_budget);
+    }
+    if (policy == "s3-fifo") {
+        return replay<S3Fifo>(keys, cache_size, byte_budget);
+    }
+    if (policy == "clock-pro") {
+        return replay<ClockPro>(keys, cache_size, byte_budget);
+    }
+    if (policy == "w-tinylfu") {
+        return replay<WTinyLfu>(keys, cache_size, byte_budget);
+    }
+    throw std::runtime_error("unknown policy " + policy);
+}
+
+std::vector<std::string_view> split(std::string_view s) {
+    std::vector<std::string_view> parts;
+    for (std::size_t comma; (comma = s.find(',')) != std::string_view::npos; s.remove_prefix(comma + 1)) {
+        parts.push_back(s.substr(0, comma));
+    }
+    parts.push_back(s);
+    return parts;
+}
+
+std::size_t to_size(const std::string_view s) {
+    std::size_t value        = 0;
+    const auto [end, error] = std::from_chars(s.data(), s.data() + s.size(), value);
+    if (error != std::errc{} || end != s.data() + s.size()) {
+        throw std::runtime_error("not a number: " + std::string(s));
+    }
+    return value;
+}
+
+double to_double(const std::string_view s) {
+    std::size_t used    = 0;
+    const double value = std::stod(std::string(s), &used);
+    if (used != s.size()) {
+        throw std::runtime_error("not a number: " + std::string(s));
+    }
+    return value;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char **argv) {
+    try {
+        std::string trace;
+        std::string format = "text";
+        Synthetic synthetic;
+        std::vector<std::size_t> sizes;
+        std::vector<std::string> policies;
+        std::uint64_t seed = 1;
+        bool byte_budget   = false;
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view option = argv[i];
+            if (option == "--bytes") {
+                byte_budget = true;
+                continue;
+            }
+            if (i + 1 == argc) {
+                std::cerr << usage;
+                return 2;
+            }
+            const std::string_view value = argv[++i];
+            if (option == "--trace") {
+                trace = value;
+            } else if (option == "--format") {
+                format = value;
+            } else if (option == "--zipf") {
+                const auto parts = split(value);
+                if (parts.size() != 3) {
+                    throw std::runtime_error("--zipf takes KEYS,ALPHA,REQUESTS");
+                }
+                synthetic.keys     = std::max<std::size_t>(1, to_size(parts[0]));
+                synthetic.alpha    = to_double(parts[1]);
+                synthetic.requests = to_size(parts[2]);
+            } else if (option == "--scan") {
+                const auto parts = split(value);
+                if (parts.size() != 2) {
+                    throw std::runtime_error("--scan takes FRACTION,LENGTH");
+                }
+                synthetic.scan_fraction = to_double(parts[0]);
+                synthetic.scan_run      = to_size(parts[1]);
+            } else if (option == "--sizes") {
+                for (const auto part : split(value)) {
+                    sizes.push_back(std::max<std::size_t>(1, to_size(part)));
+                }
+            } else if (option == "--policy") {
+                policies.emplace_back(value);
+            } else if (option == "--seed") {
+                seed = to_size(value);
+            } else {
+                std::cerr << usage;
+                return 2;
+            }
+        }
+        if (trace.empty() == (synthetic.requests == 0)) {
+            std::cerr << usage;
+            return 2;
+        }
+        const std::vector<std::uint64_t> keys =
+            trace.empty() ? generate_trace(synthetic, seed) : read_trace(trace, format);
+        const std::size_t distinct = std::unordered_set<std::uint64_t>(keys.begin(), keys.end()).size();
+        if (sizes.empty()) {
+            for (const std::size_t percent : {1, 2, 5, 10, 20, 50}) {
+                const std::size_t count = std::max<std::size_t>(1, distinct * percent / 100);
+                sizes.push_back(byte_budget ? count * average_block : count);
+            }
+        }
+        if (policies.empty()) {
+            policies = policy_names;
+        }
+        std::cout << keys.size() << " requests, " << distinct << " distinct keys\n";
+        std::cout << std::left << std::setw(14) << "policy" << std::right << std::setw(10)
+                  << (byte_budget ? "bytes" : "size") << std::setw(10) << "hit ratio" << std::setw(10) << "ns/op"
+                  << std::setw(10) << "internal" << std::setw(10) << "external" << std::setw(10) << "failures" << '\n';
+        std::cout << std::fixed;
+        for (const std::size_t size : sizes) {
+            for (const auto &policy : policies) {
+                const Result result = replay(policy, keys, size, byte_budget);
+                const double ratio =
+                    keys.empty() ? 0.0 : static_cast<double>(result.hits) / static_cast<double>(keys.size());
+                std::cout << std::left << std::setw(14) << policy << std::right << std::setw(10) << size
+                          << std::setprecision(4) << std::setw(10) << ratio << std::setprecision(1) << std::setw(10)
+                          << result.ns_per_op << std::setprecision(4) << std::setw(10) << result.internal
+                          << std::setw(10) << result.external << std::setw(10) << result.failures << '\n';
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "cachesim: " << e.what() << '\n';
+        return 1;
+    }
+}